@@ -0,0 +1,452 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "lu.h"
+#include "cholesky.h"
+
+#include <pmp/Timer.h>
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//=============================================================================
+
+/// the benchmarked solvers
+enum Solver_id
+{
+    LU_EIGEN=0,
+    LU=1,
+    CHOLESKY_EIGEN=2,
+    CHOLESKY=3,
+    QR_EIGEN=4,
+    N_SOLVERS
+};
+
+const char* solver_names[N_SOLVERS] = {"LU_EIGEN", "LU", "CHOLESKY_EIGEN",
+                                       "CHOLESKY", "QR_EIGEN"};
+
+/// order statistics of repeated measurements [ms]
+struct Statistics
+{
+    double min, p10, median, p90, max;
+};
+
+/// one solver on one input
+struct Measurement
+{
+    Solver_id  solver;
+    bool       ok;
+    Statistics factorize, solve;
+    double     gflops;
+    Scalar     residual;
+};
+
+/// one input of the sweep
+struct Case
+{
+    std::string kind;      ///< "interpolation" or "normal_equations"
+    int         n;         ///< dimension of the system
+    int         m;         ///< number of constraints
+    int         degree;    ///< polynomial degree
+    Statistics  assemble;  ///< time to set up the system [ms]
+    std::vector<Measurement> measurements;
+};
+
+/// benchmark settings
+struct Settings
+{
+    Settings() : warmup(2), repetitions(11), max_n(512), max_m(100000) {}
+
+    int warmup;      ///< untimed runs before the measurement
+    int repetitions; ///< timed runs
+    int max_n;       ///< largest interpolation system
+    int max_m;       ///< largest number of constraints
+};
+
+//-----------------------------------------------------------------------------
+
+/// percentile _p (0..1) of the sorted _samples, linearly interpolated
+double percentile(const std::vector<double>& _samples, double _p)
+{
+    const double pos = _p * (_samples.size() - 1);
+    const size_t i   = size_t(pos);
+    if (i + 1 >= _samples.size()) return _samples.back();
+    return _samples[i] + (pos - i) * (_samples[i + 1] - _samples[i]);
+}
+
+//-----------------------------------------------------------------------------
+
+Statistics statistics(std::vector<double> _samples)
+{
+    std::sort(_samples.begin(), _samples.end());
+    Statistics s;
+    s.min    = _samples.front();
+    s.p10    = percentile(_samples, 0.1);
+    s.median = percentile(_samples, 0.5);
+    s.p90    = percentile(_samples, 0.9);
+    s.max    = _samples.back();
+    return s;
+}
+
+//-----------------------------------------------------------------------------
+
+/// factorize and solve with one of Eigen's decompositions
+template <class Decomposition>
+bool run_eigen(Decomposition& _decomposition, const MatrixXX& _M,
+               const VectorX& _rhs, VectorX& _x, double& _factorize_time,
+               double& _solve_time)
+{
+    pmp::Timer timer;
+
+    timer.start();
+    _decomposition.compute(_M);
+    timer.stop();
+    _factorize_time = timer.elapsed();
+
+    timer.start();
+    _x = _decomposition.solve(_rhs);
+    timer.stop();
+    _solve_time = timer.elapsed();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+/// factorize and solve with one of our solvers
+template <class Solver>
+bool run_ours(Solver& _solver, const MatrixXX& _M, const VectorX& _rhs,
+              VectorX& _x, double& _factorize_time, double& _solve_time)
+{
+    pmp::Timer timer;
+
+    timer.start();
+    const bool ok = _solver.factorize(_M);
+    timer.stop();
+    _factorize_time = timer.elapsed();
+    if (!ok) return false;
+
+    timer.start();
+    _solver.solve(_rhs, _x);
+    timer.stop();
+    _solve_time = timer.elapsed();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+/// time _solver on M*x=rhs. The solver object is reused across the
+/// repetitions, like in the viewer, so the warm-up also grows its buffers.
+Measurement measure(Solver_id _solver, const MatrixXX& _M, const VectorX& _rhs,
+                    const Settings& _settings)
+{
+    Eigen::FullPivLU<MatrixXX>            lu_eigen;
+    Eigen::LDLT<MatrixXX>                 ldlt_eigen;
+    Eigen::FullPivHouseholderQR<MatrixXX> qr_eigen;
+    LU_Solver                             lu;
+    CholeskySolver                        cholesky;
+    lu.verbose = cholesky.verbose = false;
+
+    Measurement result;
+    result.solver = _solver;
+    result.ok     = true;
+
+    VectorX             x(_M.cols());
+    std::vector<double> factorize_times, solve_times;
+
+    for (int r = 0; r < _settings.warmup + _settings.repetitions; ++r)
+    {
+        double tf = 0.0, ts = 0.0;
+        bool   ok = true;
+        switch (_solver)
+        {
+            case LU_EIGEN:
+                ok = run_eigen(lu_eigen, _M, _rhs, x, tf, ts);
+                break;
+            case CHOLESKY_EIGEN:
+                ok = run_eigen(ldlt_eigen, _M, _rhs, x, tf, ts);
+                break;
+            case QR_EIGEN:
+                ok = run_eigen(qr_eigen, _M, _rhs, x, tf, ts);
+                break;
+            case LU:
+                ok = run_ours(lu, _M, _rhs, x, tf, ts);
+                break;
+            case CHOLESKY:
+                ok = run_ours(cholesky, _M, _rhs, x, tf, ts);
+                break;
+            default:
+                break;
+        }
+        result.ok = result.ok && ok;
+
+        if (r >= _settings.warmup)
+        {
+            factorize_times.push_back(tf);
+            solve_times.push_back(ts);
+        }
+    }
+
+    result.factorize = statistics(factorize_times);
+    result.solve     = statistics(solve_times);
+    result.residual  = result.ok ? (_M * x - _rhs).norm()
+                                 : std::numeric_limits<Scalar>::quiet_NaN();
+
+    // flops of the textbook factorizations of an n x n matrix
+    const double n = _M.rows();
+    double       flops;
+    switch (_solver)
+    {
+        case CHOLESKY_EIGEN:
+        case CHOLESKY:
+            flops = n * n * n / 3.0;
+            break;
+        case QR_EIGEN:
+            flops = 4.0 / 3.0 * n * n * n;
+            break;
+        default:
+            flops = 2.0 / 3.0 * n * n * n;
+            break;
+    }
+    result.gflops = result.factorize.median > 0.0
+                        ? flops / result.factorize.median * 1e-6
+                        : 0.0;
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+/// square Vandermonde system at n Chebyshev nodes, the best conditioned
+/// choice of nodes for monomials
+Case interpolation_case(int _n, const Settings& _settings)
+{
+    Case c;
+    c.kind   = "interpolation";
+    c.n      = _n;
+    c.m      = _n;
+    c.degree = _n - 1;
+
+    MatrixXX            A(_n, _n);
+    VectorX             b(_n);
+    std::vector<double> times;
+    pmp::Timer          timer;
+
+    for (int r = 0; r < _settings.warmup + _settings.repetitions; ++r)
+    {
+        timer.start();
+        for (int i = 0; i < _n; ++i)
+        {
+            const Scalar x = cos(M_PI * (2 * i + 1) / (2 * _n));
+            b(i)           = sin(3.0 * x);
+            Scalar p       = 1.0;
+            for (int j = 0; j < _n; ++j, p *= x) A(i, j) = p;
+        }
+        timer.stop();
+        if (r >= _settings.warmup) times.push_back(timer.elapsed());
+    }
+    c.assemble = statistics(times);
+
+    const Solver_id solvers[] = {LU_EIGEN, LU, QR_EIGEN};
+    for (Solver_id s : solvers) c.measurements.push_back(measure(s, A, b, _settings));
+
+    return c;
+}
+
+//-----------------------------------------------------------------------------
+
+/// normal equations of a degree _degree fit to _m noisy samples
+Case normal_equations_case(int _m, int _degree, const Settings& _settings)
+{
+    Case c;
+    c.kind   = "normal_equations";
+    c.n      = _degree + 1;
+    c.m      = _m;
+    c.degree = _degree;
+
+    const int n = c.n;
+    MatrixXX  A(_m, n), AtA(n, n);
+    VectorX   b(_m), Atb(n);
+
+    // reproducible noise (linear congruential generator)
+    uint32_t state = 12345;
+    for (int i = 0; i < _m; ++i)
+    {
+        state          = state * 1664525u + 1013904223u;
+        const Scalar x = -1.0 + 2.0 * i / std::max(_m - 1, 1);
+        b(i) = sin(M_PI * x) + 0.01 * (Scalar(state >> 8) / (1 << 24) - 0.5);
+        Scalar p = 1.0;
+        for (int j = 0; j < n; ++j, p *= x) A(i, j) = p;
+    }
+
+    std::vector<double> times;
+    pmp::Timer          timer;
+    for (int r = 0; r < _settings.warmup + _settings.repetitions; ++r)
+    {
+        timer.start();
+        AtA.noalias() = A.transpose() * A;
+        Atb.noalias() = A.transpose() * b;
+        timer.stop();
+        if (r >= _settings.warmup) times.push_back(timer.elapsed());
+    }
+    c.assemble = statistics(times);
+
+    for (int s = 0; s < N_SOLVERS; ++s)
+        c.measurements.push_back(measure((Solver_id)s, AtA, Atb, _settings));
+
+    return c;
+}
+
+//-----------------------------------------------------------------------------
+
+void write_statistics(std::ostream& _os, const Statistics& _s)
+{
+    _os << "{\"min\": " << _s.min << ", \"p10\": " << _s.p10
+        << ", \"median\": " << _s.median << ", \"p90\": " << _s.p90
+        << ", \"max\": " << _s.max << "}";
+}
+
+//-----------------------------------------------------------------------------
+
+/// write all results as JSON; NaN and inf are written as null
+void write_json(std::ostream& _os, const std::vector<Case>& _cases,
+                const Settings& _settings)
+{
+    _os << std::setprecision(6);
+    _os << "{\n";
+    _os << "  \"benchmark\": \"solver_bench\",\n";
+    _os << "  \"timestamp\": " << (long long)time(nullptr) << ",\n";
+    _os << "  \"scalar_bytes\": " << sizeof(Scalar) << ",\n";
+    _os << "  \"eigen_version\": \"" << EIGEN_WORLD_VERSION << "."
+        << EIGEN_MAJOR_VERSION << "." << EIGEN_MINOR_VERSION << "\",\n";
+#ifdef __VERSION__
+    _os << "  \"compiler\": \"" << __VERSION__ << "\",\n";
+#endif
+    _os << "  \"warmup\": " << _settings.warmup << ",\n";
+    _os << "  \"repetitions\": " << _settings.repetitions << ",\n";
+    _os << "  \"unit\": \"ms\",\n";
+    _os << "  \"cases\": [\n";
+    for (size_t i = 0; i < _cases.size(); ++i)
+    {
+        const Case& c = _cases[i];
+        _os << "    {\"kind\": \"" << c.kind << "\", \"n\": " << c.n
+            << ", \"m\": " << c.m << ", \"degree\": " << c.degree
+            << ", \"assemble\": ";
+        write_statistics(_os, c.assemble);
+        _os << ",\n     \"solvers\": [\n";
+        for (size_t j = 0; j < c.measurements.size(); ++j)
+        {
+            const Measurement& r = c.measurements[j];
+            _os << "       {\"solver\": \"" << solver_names[r.solver]
+                << "\", \"ok\": " << (r.ok ? "true" : "false")
+                << ", \"factorize\": ";
+            write_statistics(_os, r.factorize);
+            _os << ", \"solve\": ";
+            write_statistics(_os, r.solve);
+            _os << ", \"gflops\": " << r.gflops << ", \"residual\": ";
+            if (std::isfinite(r.residual))
+                _os << r.residual;
+            else
+                _os << "null";
+            _os << "}" << (j + 1 < c.measurements.size() ? "," : "") << "\n";
+        }
+        _os << "     ]}" << (i + 1 < _cases.size() ? "," : "") << "\n";
+    }
+    _os << "  ]\n";
+    _os << "}\n";
+}
+
+//-----------------------------------------------------------------------------
+
+/// Time our and Eigen's dense solvers on synthetic Vandermonde systems and
+/// normal equations of growing size, and write the results as JSON.
+int main(int argc, char** argv)
+{
+    Settings    settings;
+    const char* output = "solver_bench.json";
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--warmup") && i + 1 < argc)
+            settings.warmup = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--reps") && i + 1 < argc)
+            settings.repetitions = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--max-n") && i + 1 < argc)
+            settings.max_n = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--max-m") && i + 1 < argc)
+            settings.max_m = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--quick"))
+        {
+            settings.warmup      = 1;
+            settings.repetitions = 3;
+            settings.max_n       = 64;
+            settings.max_m       = 1000;
+        }
+        else if (!strcmp(argv[i], "--out") && i + 1 < argc)
+            output = argv[++i];
+        else
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--warmup <runs>] [--reps <runs>] [--max-n <n>]"
+                         " [--max-m <m>] [--quick] [--out <file.json>]\n";
+            return EXIT_FAILURE;
+        }
+    }
+    if (settings.warmup < 0 || settings.repetitions < 1)
+    {
+        std::cerr << "Need at least one repetition\n";
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Case> cases;
+
+    // matrix size
+    for (int n = 8; n <= settings.max_n; n *= 2)
+        cases.push_back(interpolation_case(n, settings));
+
+    // constraint count and polynomial degree
+    const int degrees[] = {3, 7, 15, 31};
+    for (int m = 1000; m <= settings.max_m; m *= 10)
+        for (int degree : degrees)
+            if (degree < m) cases.push_back(normal_equations_case(m, degree, settings));
+
+    // human-readable summary
+    std::cout << std::left << std::setw(18) << "kind" << std::setw(8) << "n"
+              << std::setw(8) << "m" << std::setw(16) << "solver"
+              << std::setw(14) << "factorize" << std::setw(14) << "solve"
+              << std::setw(10) << "GFLOP/s" << "residual\n";
+    for (const Case& c : cases)
+        for (const Measurement& r : c.measurements)
+            std::cout << std::setw(18) << c.kind << std::setw(8) << c.n
+                      << std::setw(8) << c.m << std::setw(16)
+                      << solver_names[r.solver] << std::setw(14)
+                      << r.factorize.median << std::setw(14) << r.solve.median
+                      << std::setw(10) << r.gflops << r.residual << "\n";
+
+    std::ofstream ofs(output);
+    if (!ofs)
+    {
+        std::cerr << "Cannot write " << output << std::endl;
+        return EXIT_FAILURE;
+    }
+    write_json(ofs, cases, settings);
+    std::cout << "Wrote " << output << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
+//=============================================================================
@@ -0,0 +1,158 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "lu.h"
+#include "cholesky.h"
+#include "workspace.h"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+//=============================================================================
+
+/// the solvers and buffers of one viewer
+struct Fitter
+{
+    Fitter()
+    {
+        lu.verbose       = false;
+        cholesky.verbose = false;
+    }
+
+    Workspace      workspace;
+    LU_Solver      lu;
+    CholeskySolver cholesky;
+};
+
+//-----------------------------------------------------------------------------
+
+/// samples of a smooth curve at _m points in [-1,1]
+void samples(int _m, std::vector<Scalar>& _x, std::vector<Scalar>& _y)
+{
+    _x.resize(_m);
+    _y.resize(_m);
+    for (int i = 0; i < _m; ++i)
+    {
+        _x[i] = -1.0 + 2.0 * i / (_m - 1);
+        _y[i] = std::sin(3.0 * _x[i]);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+/// interpolate the samples with our LU solver, like InterpolationViewer
+bool interpolate(Fitter& _fitter, const std::vector<Scalar>& _x,
+                 const std::vector<Scalar>& _y)
+{
+    const int m = _x.size();
+    Workspace& workspace = _fitter.workspace;
+    Workspace::MatrixBlock A = workspace.matrix(Workspace::SYSTEM, m, m);
+    Workspace::VectorBlock b = workspace.vector(Workspace::RHS, m);
+    Workspace::VectorBlock x = workspace.vector(Workspace::SOLUTION, m);
+    Workspace::VectorBlock r = workspace.vector(Workspace::RESIDUAL, m);
+
+    for (int i = 0; i < m; ++i)
+    {
+        b(i) = _y[i];
+        for (int j = 0; j < m; ++j) A(i, j) = std::pow(_x[i], j);
+    }
+
+    if (!_fitter.lu.factorize(A)) return false;
+    _fitter.lu.solve(b, x);
+
+    r.noalias() = A * x;
+    r -= b;
+    return r.norm() < 1e-6;
+}
+
+//-----------------------------------------------------------------------------
+
+/// least squares fit of degree _degree with our Cholesky solver on the
+/// normal equations, like ApproximationViewer
+bool approximate(Fitter& _fitter, const std::vector<Scalar>& _x,
+                 const std::vector<Scalar>& _y, int _degree)
+{
+    const int m = _x.size(), n = _degree + 1;
+    Workspace& workspace = _fitter.workspace;
+    Workspace::MatrixBlock A = workspace.matrix(Workspace::SYSTEM, m, n);
+    Workspace::VectorBlock b = workspace.vector(Workspace::RHS, m);
+    Workspace::VectorBlock x = workspace.vector(Workspace::SOLUTION, n);
+
+    for (int i = 0; i < m; ++i)
+    {
+        b(i) = _y[i];
+        for (int j = 0; j < n; ++j) A(i, j) = std::pow(_x[i], j);
+    }
+
+    Workspace::MatrixBlock AtA =
+        workspace.matrix(Workspace::NORMAL_MATRIX, n, n);
+    Workspace::VectorBlock Atb = workspace.vector(Workspace::NORMAL_RHS, n);
+    AtA.noalias() = A.transpose() * A;
+    Atb.noalias() = A.transpose() * b;
+
+    if (!_fitter.cholesky.factorize(AtA)) return false;
+    _fitter.cholesky.solve(Atb, x);
+
+    // the residual of the normal equations
+    Workspace::VectorBlock r = workspace.vector(Workspace::SCRATCH, n);
+    r.noalias() = AtA * x;
+    r -= Atb;
+    return r.norm() < 1e-6 * Atb.norm() + 1e-12;
+}
+
+//-----------------------------------------------------------------------------
+
+/// Runs _fit twice. The second run has to reuse the buffers of the first,
+/// and a smaller fit afterwards as well.
+template <class Fit>
+bool check(const char* _name, Fit _fit)
+{
+    const unsigned long before = Workspace::allocations();
+    const bool first = _fit(1.0);
+    const unsigned long warm = Workspace::allocations();
+    const bool again = _fit(1.0);
+    const bool smaller = _fit(0.5);
+    const unsigned long after = Workspace::allocations();
+
+    const bool ok = first && again && smaller && after == warm;
+    std::cout << std::setw(14) << _name << std::setw(8) << warm - before
+              << std::setw(8) << after - warm << std::setw(6)
+              << (ok ? "ok" : "FAIL") << std::endl;
+    return ok;
+}
+
+//=============================================================================
+
+int main()
+{
+    std::vector<Scalar> x, y;
+
+    std::cout << "           fit   first   again\n";
+
+    bool ok = true;
+
+    Fitter interpolation;
+    ok = check("interpolation", [&](double _scale) {
+             samples(int(12 * _scale), x, y);
+             return interpolate(interpolation, x, y);
+         }) && ok;
+
+    Fitter approximation;
+    ok = check("approximation", [&](double _scale) {
+             samples(int(500 * _scale), x, y);
+             return approximate(approximation, x, y, int(10 * _scale));
+         }) && ok;
+
+    return ok ? 0 : 1;
+}
+
+//=============================================================================
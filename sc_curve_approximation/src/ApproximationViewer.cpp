@@ -12,8 +12,12 @@
 #include <imgui.h>
 #include "lu.h"
 #include "cholesky.h"
+#include "cross_validation.h"
+#include "condition.h"
 #include <Eigen/Dense>
+#include <pmp/Timer.h>
 #include <sstream>
+#include <limits>
 
 //== IMPLEMENTATION ==========================================================
 
@@ -26,6 +30,44 @@ ApproximationViewer::ApproximationViewer(const char* _title, int _width,
     interpolation_solver_ = LU_EIGEN;
     approximation_solver_ = CHOLESKY_EIGEN;
     poly_degree_          = 0;
+    auto_degree_          = false;
+    degree_criterion_     = LOO;
+    show_shootout_        = false;
+    live_shootout_        = true;
+    shootout_generation_  = 0;
+    shootout_requested_   = true;
+
+    // we report the residual of the fit ourselves
+    cholesky_solver_.verbose = false;
+    cholesky_solver_.cancel  = [this]() { return fit_worker_.cancelled(); };
+}
+
+//-----------------------------------------------------------------------------
+
+ApproximationViewer::~ApproximationViewer()
+{
+    fit_worker_.stop();
+}
+
+//-----------------------------------------------------------------------------
+
+bool ApproximationViewer::load_dataset(const std::string& _filename)
+{
+    // interpolating a dataset makes no sense
+    fitting_ = APPROXIMATE;
+    return InterpolationViewer::load_dataset(_filename);
+}
+
+//-----------------------------------------------------------------------------
+
+int ApproximationViewer::max_degree() const
+{
+    // for datasets the slider would be unusable otherwise, and the normal
+    // equations of monomials are hopelessly ill-conditioned beyond this anyway
+    const int max_dataset_degree = 20;
+
+    const int m = n_constraints();
+    return dataset_ ? std::min(m - 1, max_dataset_degree) : m - 1;
 }
 
 //-----------------------------------------------------------------------------
@@ -48,6 +90,9 @@ void ApproximationViewer::keyboard(int key, int code, int action, int mods)
                         interpolation_solver_ = LU;
                         break;
                     case LU:
+                        interpolation_solver_ = LU_AUTO;
+                        break;
+                    case LU_AUTO:
                         interpolation_solver_ = LU_EIGEN;
                         break;
                 }
@@ -63,6 +108,9 @@ void ApproximationViewer::keyboard(int key, int code, int action, int mods)
                         approximation_solver_ = QR_EIGEN;
                         break;
                     case QR_EIGEN:
+                        approximation_solver_ = AUTO;
+                        break;
+                    case AUTO:
                         approximation_solver_ = CHOLESKY_EIGEN;
                         break;
                 }
@@ -76,16 +124,12 @@ void ApproximationViewer::keyboard(int key, int code, int action, int mods)
         case GLFW_KEY_1:
         {
             // get constraints by sampling a sine-curve
-            constraints_x_.clear();
-            constraints_y_.clear();
+            close_dataset();
+            clear_constraints();
 
-            constraints_x_.push_back(-0.5);
-            constraints_x_.push_back(0);
-            constraints_x_.push_back(0.5);
-
-            constraints_y_.push_back(-1 + 0.5);
-            constraints_y_.push_back(0.5);
-            constraints_y_.push_back(-1 + 0.5);
+            add_constraint(-0.5, -1 + 0.5);
+            add_constraint(0, 0.5);
+            add_constraint(0.5, -1 + 0.5);
 
             // interpolate constraints
             fit_curve();
@@ -107,12 +151,11 @@ void ApproximationViewer::keyboard(int key, int code, int action, int mods)
                 dx = 0.025;
 
             // get constraints by sampling a sine-curve
-            constraints_x_.clear();
-            constraints_y_.clear();
+            close_dataset();
+            clear_constraints();
             for (Scalar x = -1.0; x <= 1.0; x += dx)
             {
-                constraints_x_.push_back(x);
-                constraints_y_.push_back(x * 0.7 * sin(10.0 * x));
+                add_constraint(x, x * 0.7 * sin(10.0 * x));
             }
 
             // interpolate or approximate constraints
@@ -133,12 +176,11 @@ void ApproximationViewer::keyboard(int key, int code, int action, int mods)
                 dx = 0.025;
 
             // get constraints by sampling a sine-curve
-            constraints_x_.clear();
-            constraints_y_.clear();
+            close_dataset();
+            clear_constraints();
             for (Scalar x = -1.0; x <= 1.0; x += dx)
             {
-                constraints_x_.push_back(x);
-                constraints_y_.push_back(0.5 * x + 0.25 * sin(7.0 * x));
+                add_constraint(x, 0.5 * x + 0.25 * sin(7.0 * x));
             }
 
 
@@ -150,9 +192,11 @@ void ApproximationViewer::keyboard(int key, int code, int action, int mods)
         // c -> clear points and reset curve
         case GLFW_KEY_C:
         {
+            cancel_fit();
+            close_dataset();
             coefficients_.clear();
-            constraints_x_.clear();
-            constraints_y_.clear();
+            clear_constraints();
+            cv_scores_.clear();
             poly_degree_ = 0;
             break;
         }
@@ -161,14 +205,25 @@ void ApproximationViewer::keyboard(int key, int code, int action, int mods)
         case GLFW_KEY_F2:
         case GLFW_KEY_F1:
         {
+            auto_degree_ = false;
             poly_degree_ =
-                (key == GLFW_KEY_F2 ? std::min(poly_degree_+1, (int)constraints_x_.size()-1) : std::max(0, poly_degree_-1));
+                (key == GLFW_KEY_F2 ? std::min(poly_degree_+1, max_degree()) : std::max(0, poly_degree_-1));
             std::cout << "Approximate with degree " << poly_degree_
                       << " polynomial\n";
             fit_curve();
             break;
         }
 
+        // toggle automatic degree selection by cross-validation
+        case GLFW_KEY_F3:
+        {
+            auto_degree_ = !auto_degree_;
+            std::cout << "Automatic degree selection "
+                      << (auto_degree_ ? "on" : "off") << std::endl;
+            fit_curve();
+            break;
+        }
+
         // switch to approximation mode
         case GLFW_KEY_A:
         {
@@ -217,10 +272,16 @@ void ApproximationViewer::processImGUI()
             fit_curve();
         }
 
+        if (fit_worker_.busy()) ImGui::Text("Fitting...");
+
+        ImGui::Checkbox("Solver Shoot-out", &show_shootout_);
+
         ImGui::Spacing();
         ImGui::Spacing();
     }
 
+    if (show_shootout_) process_shootout_gui();
+
     if(fitting_ == INTERPOLATE)
         InterpolationViewer::processImGUI();
     else
@@ -232,28 +293,61 @@ void ApproximationViewer::processImGUI()
             ImGui::RadioButton("Eigen's Cholesky", &solver, 0);
             ImGui::RadioButton("Our Cholesky",     &solver, 1);
             ImGui::RadioButton("Eigen's QR",       &solver, 2);
+            ImGui::RadioButton("Automatic",        &solver, 3);
             if (solver != approximation_solver_)
             {
                 approximation_solver_ = (Solver)solver;
                 fit_curve();
             }
 
+            show_solver_report();
+
             ImGui::Spacing();
             ImGui::Spacing();
 
             ImGui::PushItemWidth(100);
-            poly_degree_ = std::max(0, std::min(poly_degree_, (int)constraints_x_.size()-1));
+            poly_degree_ = std::max(0, std::min(poly_degree_, max_degree()));
             int degree = poly_degree_;
-            ImGui::SliderInt("Degree", &degree, 0, std::max(0, (int)constraints_x_.size()-1));
+            ImGui::SliderInt("Degree", &degree, 0, std::max(0, max_degree()));
             ImGui::PopItemWidth();
             if (degree != poly_degree_)
             {
+                // picking a degree by hand overrides the automatic choice
+                auto_degree_ = false;
                 poly_degree_ = degree;
                 fit_curve();
             }
 
             ImGui::Spacing();
             ImGui::Spacing();
+
+            // automatic degree selection by cross-validation
+            // (not available for datasets)
+            bool auto_degree = auto_degree_;
+            if (!dataset_) ImGui::Checkbox("Auto Degree", &auto_degree);
+            int criterion = (int)degree_criterion_;
+            if (auto_degree)
+            {
+                ImGui::RadioButton("Leave-one-out", &criterion, 0);
+                ImGui::RadioButton("GCV",           &criterion, 1);
+            }
+            if (auto_degree != auto_degree_ || criterion != degree_criterion_)
+            {
+                auto_degree_      = auto_degree;
+                degree_criterion_ = (Degree_criterion)criterion;
+                fit_curve();
+            }
+
+            if (auto_degree_ && !dataset_ && !cv_scores_.empty())
+            {
+                ImGui::Text("Best degree: %d", poly_degree_);
+                ImGui::PlotLines("##cv_scores", cv_scores_.data(), cv_scores_.size(),
+                                 0, "log10(score)", FLT_MAX, FLT_MAX,
+                                 ImVec2(160, 60));
+            }
+
+            ImGui::Spacing();
+            ImGui::Spacing();
         }
     }
     ImGui::Spacing();
@@ -266,12 +360,106 @@ void ApproximationViewer::processImGUI()
 
 //-----------------------------------------------------------------------------
 
-void ApproximationViewer::fit_curve()
+void ApproximationViewer::process_shootout_gui()
 {
-    if (fitting_ == INTERPOLATE)
-        InterpolationViewer::fit_curve();
+    ImGui::SetNextWindowSize(ImVec2(560, 0), ImGuiCond_Once);
+    ImGui::Begin("Solver Shoot-out", &show_shootout_);
+
+    ImGui::Checkbox("Live", &live_shootout_);
+    ImGui::SameLine();
+    if (ImGui::Button("Run")) shootout_requested_ = true;
+    if (shootout_.busy())
+    {
+        ImGui::SameLine();
+        ImGui::Text("Running...");
+    }
+
+    const std::vector<SolverTiming> timings = shootout_.timings();
+
+    ImGui::Columns(5, "shootout");
+    ImGui::Text("Solver");      ImGui::NextColumn();
+    ImGui::Text("Factorize");   ImGui::NextColumn();
+    ImGui::Text("Solve");       ImGui::NextColumn();
+    ImGui::Text("Residual");    ImGui::NextColumn();
+    ImGui::Text("GFLOP/s");     ImGui::NextColumn();
+    ImGui::Separator();
+    for (const SolverTiming& timing : timings)
+    {
+        if (!timing.applicable || timing.history.empty()) continue;
+        ImGui::Text("%s", timing.name.c_str());           ImGui::NextColumn();
+        ImGui::Text("%.3f ms", timing.factorize_time);    ImGui::NextColumn();
+        ImGui::Text("%.3f ms", timing.solve_time);        ImGui::NextColumn();
+        ImGui::Text("%.2e", timing.residual);             ImGui::NextColumn();
+        ImGui::Text("%.2f", timing.gflops);               ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+    ImGui::Separator();
+
+    // total time of the recent runs
+    for (const SolverTiming& timing : timings)
+    {
+        if (!timing.applicable || timing.history.empty()) continue;
+        ImGui::PlotLines(timing.name.c_str(), timing.history.data(),
+                         timing.history.size(), 0, "ms", 0.0f, FLT_MAX,
+                         ImVec2(400, 40));
+    }
+
+    ImGui::End();
+}
+
+//-----------------------------------------------------------------------------
+
+void ApproximationViewer::doProcessing()
+{
+    InterpolationViewer::doProcessing();
+
+    // (re)run the shoot-out on the latest constraints and settings, but do
+    // not queue runs while one is in progress
+    if (show_shootout_ && !shootout_.busy() &&
+        (shootout_requested_ ||
+         (live_shootout_ && shootout_generation_ != fit_generation_)))
+    {
+        FitRequest request;
+        make_request(request);
+        shootout_.run(request);
+        shootout_generation_ = fit_generation_;
+        shootout_requested_  = false;
+    }
+}
+//-----------------------------------------------------------------------------
+
+void ApproximationViewer::make_request(FitRequest& _request) const
+{
+    InterpolationViewer::make_request(_request);
+    _request.fitting              = fitting_;
+    _request.approximation_solver = approximation_solver_;
+    _request.degree               = poly_degree_;
+    _request.auto_degree          = auto_degree_ && !dataset_;
+    _request.degree_criterion     = degree_criterion_;
+}
+
+//-----------------------------------------------------------------------------
+
+bool ApproximationViewer::fit(const FitRequest& _request, FitResult& _result)
+{
+    if (_request.fitting == INTERPOLATE)
+        return InterpolationViewer::fit(_request, _result);
     else
-        approximate();
+        return approximate(_request, _result);
+}
+
+//-----------------------------------------------------------------------------
+
+void ApproximationViewer::accept(const FitResult& _result)
+{
+    InterpolationViewer::accept(_result);
+
+    // take over the degree chosen by cross-validation
+    if (_result.degree >= 0)
+    {
+        poly_degree_ = _result.degree;
+        cv_scores_   = _result.cv_scores;
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -283,91 +471,362 @@ void ApproximationViewer::add_noise(Scalar _amplitude)
  * The offset should be between `-_amplitude` and `_amplitude`.
  */
 
+// the samples of a dataset are mapped read-only
+if (dataset_) {
+  std::cerr << "Cannot add noise to a dataset\n";
+  return;
+}
+
 for (auto &y : constraints_y_) {
   y += -_amplitude + static_cast <float> (rand()) /
                          (static_cast <float> (RAND_MAX / (2 * _amplitude)));
 }
 
+// the same points with other y-coordinates need other fits
+rehash_constraints();
+
 }
 
 //-----------------------------------------------------------------------------
 
-void ApproximationViewer::approximate()
+bool ApproximationViewer::approximate(const FitRequest& _request,
+                                      FitResult& _result)
 {
   /**
    * Determine the polynomial coefficients as the
    * least squares solution of the overdetermined problem `A * x = b`.
    * - Setup the overdetermined system `A * x = b`. Make sure to set `m` and `n` correctly.
-   *   The polynom's intended degree is stored in `poly_degree_`.
+   *   The polynom's intended degree is stored in `_request.degree`.
    * - Setup the normal equations.
-   * - Depending on the variable `approximation_solver_`, use Eigen's or your own
+   * - Depending on `_request.approximation_solver`, use Eigen's or your own
    *   Cholesky solver to solve the normal equations, or use Eigens's QR
    *   solver to solve the overdetermined system `A * x = b` directly.
-   * - Copy the solution in `x` to the `coefficients_` vector.
+   * - Copy the solution in `x` to the `_result.coefficients` vector.
    *
    * To find out how to use Eigen's Cholesky and QR solvers, simply run a Google search for the terms.
    */
 
-  assert(constraints_x_.size() == constraints_y_.size());
+  assert(_request.x.size() == _request.y.size());
+
+  // pick the degree by cross-validation first, if requested
+  int degree = _request.degree;
+  if (_request.auto_degree)
+  {
+      if (!select_degree(_request, _result)) return false;
+      degree = _result.degree;
+  }
+
+  // samples of a dataset go straight into the normal equations
+  if (_request.dataset) return approximate_dataset(_request, _result);
 
   unsigned int i, j;
-  unsigned int m = constraints_x_.size();
-  unsigned int n = poly_degree_ + 1;
-  MatrixXX A(m, n);
-  VectorX b(m), x(n);
+  unsigned int m = _request.x.size();
+  unsigned int n = degree + 1;
+  Workspace::MatrixBlock A = workspace_.matrix(Workspace::SYSTEM, m, n);
+  Workspace::VectorBlock b = workspace_.vector(Workspace::RHS, m);
+  Workspace::VectorBlock x = workspace_.vector(Workspace::SOLUTION, n);
+  Workspace::VectorBlock r = workspace_.vector(Workspace::RESIDUAL, m);
 
   // Fill the system's right hand side 'b'
   for (i = 0; i < m; i++) {
-      b(i) = constraints_y_[i];
+      b(i) = _request.y[i];
   }
 
   // Setup overdetermined system A * x = b
   // Fill matrix 'A'
   for (i = 0; i < m; i++) {
       for (j = 0; j < n ; j++) {
-          A(i, j) = pow(constraints_x_[i], j);
+          A(i, j) = pow(_request.x[i], j);
       }
   }
 
   // Setup normal equations
-  MatrixXX AtA = A.transpose() * A;
-  VectorX Atb = A.transpose() * b;
+  Workspace::MatrixBlock AtA =
+      workspace_.matrix(Workspace::NORMAL_MATRIX, n, n);
+  Workspace::VectorBlock Atb = workspace_.vector(Workspace::NORMAL_RHS, n);
+  AtA.noalias() = A.transpose() * A;
+  Atb.noalias() = A.transpose() * b;
+
+  if (!solve_least_squares(_request, A, b, AtA, Atb, x, _result))
+      return false;
+
+  r.noalias() = A * x;
+  r -= b;
+  std::cout << "Error A: " << r.norm() << std::endl;
+
+  // copy solution to coefficients vector
+  _result.coefficients.resize(n);
+  for (i = 0; i < n; ++i) _result.coefficients[i] = x(i);
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool ApproximationViewer::approximate_dataset(const FitRequest& _request,
+                                              FitResult& _result)
+{
+  const Dataset& dataset = *_request.dataset;
+
+  const int n = _request.degree + 1;
+  Workspace::MatrixBlock AtA =
+      workspace_.matrix(Workspace::NORMAL_MATRIX, n, n);
+  Workspace::VectorBlock Atb = workspace_.vector(Workspace::NORMAL_RHS, n);
+  Workspace::VectorBlock x   = workspace_.vector(Workspace::SOLUTION, n);
+
+  // one pass over the mapped samples, A is never formed
+  dataset.normal_equations(_request.degree, AtA, Atb);
+  if (fit_worker_.cancelled()) return false;
+
+  // A is never formed, so only the normal equations are available
+  if (!solve_least_squares(_request, workspace_.matrix(Workspace::SYSTEM, 0, n),
+                           workspace_.vector(Workspace::RHS, 0), AtA, Atb, x,
+                           _result))
+      return false;
+
+  std::cout << "Error A: " << sqrt(dataset.squared_residual(x)) << std::endl;
+
+  _result.coefficients.resize(n);
+  for (int i = 0; i < n; ++i) _result.coefficients[i] = x(i);
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool ApproximationViewer::solve_least_squares(
+    const FitRequest& _request, const Eigen::Ref<const MatrixXX>& A,
+    const Eigen::Ref<const VectorX>& b, const Eigen::Ref<const MatrixXX>& AtA,
+    const Eigen::Ref<const VectorX>& Atb, Eigen::Ref<VectorX> x,
+    FitResult& _result)
+{
+  const int n = AtA.rows();
+
+  pmp::Timer timer;
+  timer.start();
 
   // Use correct solver
-  switch(approximation_solver_) {
+  switch(_request.approximation_solver) {
 
       case CHOLESKY_EIGEN:
       {
           // Eigen Cholesky solver
-          x = AtA.ldlt().solve(Atb);
-
-          std::cout << "Error AtA: " << (AtA*x-Atb).norm() << std::endl;
+          ldlt_eigen_.compute(AtA);
+          x = ldlt_eigen_.solve(Atb);
 
           break;
       }
       case QR_EIGEN:
       {
           // Eigen QR solver
-          x = AtA.fullPivHouseholderQr().solve(Atb);
-
-          std::cout << "Error AtA: " << (AtA*x-Atb).norm() << std::endl;
+          qr_eigen_.compute(AtA);
+          x = qr_eigen_.solve(Atb);
 
           break;
       }
 
       case CHOLESKY:
       {
-          CholeskySolver solver;
-          if (solver.factorize(AtA)) solver.solve(Atb, x);
+          if (cholesky_solver_.factorize(AtA))
+              cholesky_solver_.solve(Atb, x);
+          else if (fit_worker_.cancelled())
+              return false;
+          break;
+      }
+
+      case AUTO:
+      {
+          if (!solve_least_squares_automatic(A, b, AtA, Atb, x, _result))
+              return false;
           break;
       }
   }
 
-  std::cout << "Error A: " << (A*x-b).norm() << std::endl;
+  timer.stop();
+  _result.solve_time = timer.elapsed();
 
-  // copy solution to coefficients vector
-  coefficients_.resize(n);
-  for (i = 0; i < n; ++i) coefficients_[i] = x(i);
+  // residual without temporaries
+  Workspace::VectorBlock s = workspace_.vector(Workspace::SCRATCH, n);
+  s.noalias() = AtA * x;
+  s -= Atb;
+  std::cout << "Error AtA: " << s.norm() << std::endl;
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool ApproximationViewer::select_degree(const FitRequest& _request,
+                                        FitResult& _result)
+{
+    /**
+     * Fit every degree once and score it by its exact leave-one-out residuals
+     * (or their GCV approximation). The leave-one-out residuals follow from
+     * the diagonal of the hat matrix, which the Cholesky factor of the normal
+     * equations gives in O(m*n^2), so no degree has to be refitted m times.
+     */
+
+    assert(_request.x.size() == _request.y.size());
+
+    const int m = _request.x.size();
+    _result.cv_scores.clear();
+    _result.degree = 0;
+
+    // leave at least one residual degree of freedom
+    if (m < 2) return true;
+
+    int    best_degree = 0;
+    Scalar best_score  = std::numeric_limits<Scalar>::max();
+
+    Workspace::VectorBlock b = workspace_.vector(Workspace::RHS, m);
+    for (int i = 0; i < m; ++i) b(i) = _request.y[i];
+
+    for (int degree = 0; degree <= m - 2; ++degree)
+    {
+        // newer input arrived, this selection is not needed anymore
+        if (fit_worker_.cancelled()) return false;
+
+        const int n = degree + 1;
+
+        Workspace::MatrixBlock A = workspace_.matrix(Workspace::SYSTEM, m, n);
+        for (int i = 0; i < m; ++i)
+            for (int j = 0; j < n; ++j)
+                A(i, j) = pow(_request.x[i], j);
+
+        Workspace::MatrixBlock AtA =
+            workspace_.matrix(Workspace::NORMAL_MATRIX, n, n);
+        Workspace::VectorBlock Atb =
+            workspace_.vector(Workspace::NORMAL_RHS, n);
+        Workspace::VectorBlock x = workspace_.vector(Workspace::SOLUTION, n);
+        Workspace::VectorBlock w = workspace_.vector(Workspace::SCRATCH, n);
+        AtA.noalias() = A.transpose() * A;
+        Atb.noalias() = A.transpose() * b;
+
+        // higher degrees only get worse conditioned, so stop at the first
+        // failure. A cancelled factorization fails as well, but then the
+        // selection is incomplete and must not be published.
+        if (!cholesky_solver_.factorize(AtA))
+        {
+            if (fit_worker_.cancelled()) return false;
+            break;
+        }
+        cholesky_solver_.solve(Atb, x);
+
+        CrossValidation cv;
+        if (!cross_validation(A, b, x, cholesky_solver_.L.topLeftCorner(n, n),
+                              w, cv))
+            break;
+
+        const Scalar score =
+            (_request.degree_criterion == LOO ? cv.loo : cv.gcv);
+        _result.cv_scores.push_back(log10(std::max(score, (Scalar)1e-30)));
+
+        if (score < best_score)
+        {
+            best_score  = score;
+            best_degree = degree;
+        }
+    }
+
+    _result.degree = best_degree;
+
+    std::cout << "Cross-validation ("
+              << (_request.degree_criterion == LOO ? "leave-one-out" : "GCV")
+              << ") selects degree " << best_degree << ", score "
+              << best_score << std::endl;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool ApproximationViewer::solve_least_squares_automatic(
+    const Eigen::Ref<const MatrixXX>& _A, const Eigen::Ref<const VectorX>& _b,
+    const Eigen::Ref<const MatrixXX>& _AtA, const Eigen::Ref<const VectorX>& _Atb,
+    Eigen::Ref<VectorX> _x, FitResult& _result)
+{
+    /**
+     * Escalate from the cheapest to the most robust solver:
+     * 1. Cholesky of A^T*A: n^3/3 flops after forming A^T*A, but its
+     *    condition number is cond(A)^2.
+     * 2. Column-pivoting QR of A: 2*m*n^2 flops, error only grows with
+     *    cond(A), since A^T*A is never used.
+     * 3. Complete orthogonal decomposition: for (numerically) rank-deficient
+     *    A it returns the minimum-norm solution.
+     * Each step is only taken if the 1-norm condition estimate of the
+     * previous one, which reuses its factors in O(n^2), is too large.
+     */
+
+    const int n = _AtA.rows();
+    Workspace::VectorBlock u = workspace_.vector(Workspace::ESTIMATE_X, n);
+    Workspace::VectorBlock v = workspace_.vector(Workspace::ESTIMATE_Y, n);
+
+    // 1. Cholesky of the normal equations (symmetric, so M^-T = M^-1)
+    llt_eigen_.compute(_AtA);
+    _result.solver    = "Cholesky";
+    _result.condition = std::numeric_limits<Scalar>::infinity();
+    if (llt_eigen_.info() == Eigen::Success)
+    {
+        Solve_function solve = [this](const Eigen::Ref<const VectorX>& _in,
+                                      Eigen::Ref<VectorX> _out) {
+            _out = llt_eigen_.solve(_in);
+        };
+        _result.condition = condition_estimate(norm1(_AtA), solve, solve, u, v);
+    }
+
+    if (is_well_conditioned(_result.condition))
+    {
+        _x = llt_eigen_.solve(_Atb);
+    }
+    else if (_A.rows() > 0)
+    {
+        if (fit_worker_.cancelled()) return false;
+
+        // 2. QR of A itself, estimate the condition of its triangular factor
+        colpiv_qr_eigen_.compute(_A);
+        const Eigen::Ref<const MatrixXX> R =
+            colpiv_qr_eigen_.matrixQR().topLeftCorner(n, n);
+        _result.solver += " -> QR";
+        _result.condition = condition_estimate(
+            upper_norm1(R),
+            [&R](const Eigen::Ref<const VectorX>& _in, Eigen::Ref<VectorX> _out) {
+                _out = _in;
+                R.triangularView<Eigen::Upper>().solveInPlace(_out);
+            },
+            [&R](const Eigen::Ref<const VectorX>& _in, Eigen::Ref<VectorX> _out) {
+                _out = _in;
+                R.triangularView<Eigen::Upper>().transpose().solveInPlace(_out);
+            },
+            u, v);
+
+        if (is_well_conditioned(_result.condition))
+        {
+            _x = colpiv_qr_eigen_.solve(_b);
+        }
+        else
+        {
+            if (fit_worker_.cancelled()) return false;
+
+            // 3. rank-deficient: minimum-norm solution
+            cod_eigen_.compute(_A);
+            _x = cod_eigen_.solve(_b);
+            _result.solver += " -> COD";
+        }
+    }
+    else
+    {
+        if (fit_worker_.cancelled()) return false;
+
+        // without A, the best we can do is a rank-revealing solve of A^T*A
+        cod_eigen_.compute(_AtA);
+        _x = cod_eigen_.solve(_Atb);
+        _result.solver += " -> COD";
+    }
+
+    std::cout << "Automatic solver: " << _result.solver << " (condition "
+              << _result.condition << ")\n";
+
+    return true;
 }
 
 //=============================================================================
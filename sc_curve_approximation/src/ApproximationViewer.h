@@ -11,6 +11,8 @@
 //=============================================================================
 
 #include "InterpolationViewer.h"
+#include "cholesky.h"
+#include "solver_shootout.h"
 
 //== CLASS DEFINITION =========================================================
 
@@ -22,6 +24,12 @@ public:
     /// constructor
     ApproximationViewer(const char* _title, int _width, int _height);
 
+    /// destructor, stops the fitting thread before our members are gone
+    virtual ~ApproximationViewer();
+
+    /// use the samples of a dataset file as constraints (approximation only)
+    virtual bool load_dataset(const std::string& _filename) override;
+
 protected:
 
     /// render/handle GUI
@@ -30,14 +38,56 @@ protected:
     /// this function handles keyboard events
     virtual void keyboard(int key, int code, int action, int mods) override;
 
+    /// picks up fit results and restarts the solver shoot-out
+    virtual void doProcessing() override;
+
+    /// window with the timings of the solver shoot-out
+    void process_shootout_gui();
+
     /// add noise to the y-coordinate of constraints
     void add_noise(Scalar _amplitude);
 
+    /// store the current constraints and settings in _request
+    virtual void make_request(FitRequest& _request) const override;
+
     /// overload this method: interpolate OR approximate constraints
-    virtual void fit_curve() override;
+    virtual bool fit(const FitRequest& _request, FitResult& _result) override;
+
+    /// show the result of a fit
+    virtual void accept(const FitResult& _result) override;
 
     /// compute polynomial that approximates the constraints
-    void approximate();
+    bool approximate(const FitRequest& _request, FitResult& _result);
+
+    /// compute polynomial that approximates the samples of a dataset
+    bool approximate_dataset(const FitRequest& _request, FitResult& _result);
+
+    /// solve the least squares problem with the requested solver. All but
+    /// the automatic solver only use the normal equations _AtA, _Atb.
+    bool solve_least_squares(const FitRequest& _request,
+                             const Eigen::Ref<const MatrixXX>& _A,
+                             const Eigen::Ref<const VectorX>& _b,
+                             const Eigen::Ref<const MatrixXX>& _AtA,
+                             const Eigen::Ref<const VectorX>& _Atb,
+                             Eigen::Ref<VectorX> _x, FitResult& _result);
+
+    /// Solve the least squares problem by Cholesky on the normal equations,
+    /// and escalate to QR (or a complete orthogonal decomposition) of _A
+    /// only if the estimated condition number demands it. _A may be empty
+    /// (datasets), then the normal equations are the only input. Returns
+    /// false if the fit got cancelled.
+    bool solve_least_squares_automatic(const Eigen::Ref<const MatrixXX>& _A,
+                                       const Eigen::Ref<const VectorX>& _b,
+                                       const Eigen::Ref<const MatrixXX>& _AtA,
+                                       const Eigen::Ref<const VectorX>& _Atb,
+                                       Eigen::Ref<VectorX> _x,
+                                       FitResult& _result);
+
+    /// highest polynomial degree offered for the current constraints
+    int max_degree() const;
+
+    /// choose the degree by (leave-one-out or generalized) cross-validation
+    bool select_degree(const FitRequest& _request, FitResult& _result);
 
 protected:
 
@@ -53,10 +103,50 @@ protected:
     {
         CHOLESKY_EIGEN=0,
         CHOLESKY=1,
-        QR_EIGEN=2
+        QR_EIGEN=2,
+        AUTO=3
     } approximation_solver_;
 
     int poly_degree_;
+
+    /// select the polynomial degree automatically?
+    bool auto_degree_;
+
+    /// which cross-validation score to minimize for automatic degree selection
+    enum Degree_criterion
+    {
+        LOO=0,
+        GCV=1
+    } degree_criterion_;
+
+    /// log10 of the cross-validation score of each tested degree
+    std::vector<float> cv_scores_;
+
+    /// our Cholesky solver, kept to reuse its factor buffers
+    CholeskySolver cholesky_solver_;
+
+    /// Eigen's Cholesky solver, kept to reuse its factor buffers
+    Eigen::LDLT<MatrixXX> ldlt_eigen_;
+
+    /// Eigen's QR solver, kept to reuse its factor buffers
+    Eigen::FullPivHouseholderQR<MatrixXX> qr_eigen_;
+
+    /// times all solvers concurrently on the current constraints
+    SolverShootout shootout_;
+
+    /// show the shoot-out window, rerun it whenever the fit changes?
+    bool show_shootout_, live_shootout_;
+
+    /// generation of the fit the shoot-out last ran on
+    unsigned long shootout_generation_;
+
+    /// run the shoot-out as soon as possible (Run button)?
+    bool shootout_requested_;
+
+    /// the escalation steps of the automatic solver
+    Eigen::LLT<MatrixXX>                            llt_eigen_;
+    Eigen::ColPivHouseholderQR<MatrixXX>            colpiv_qr_eigen_;
+    Eigen::CompleteOrthogonalDecomposition<MatrixXX> cod_eigen_;
 };
 
 //=============================================================================
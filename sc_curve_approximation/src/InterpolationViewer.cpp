@@ -9,7 +9,9 @@
 //=============================================================================
 
 #include "InterpolationViewer.h"
+#include "condition.h"
 #include <imgui.h>
+#include <pmp/Timer.h>
 
 //== IMPLEMENTATION ==========================================================
 
@@ -19,6 +21,19 @@ InterpolationViewer(const char* _title, int _width, int _height)
 {
     // start with Eigen's solver
     interpolation_solver_ = LU_EIGEN;
+    solver_condition_     = 0.0;
+    solve_time_           = 0.0;
+    dataset_loads_        = 0;
+
+    // we report the residual of the fit ourselves
+    lu_solver_.verbose = false;
+    lu_solver_.cancel  = [this]() { return fit_worker_.cancelled(); };
+
+    // fits run in the background
+    fit_generation_ = shown_generation_ = 0;
+    fit_worker_.start([this](const FitRequest& _request, FitResult& _result) {
+        return fit(_request, _result);
+    });
 
     // OpenGL state
     glClearColor(1.0, 1.0, 1.0, 0.0);
@@ -32,6 +47,88 @@ InterpolationViewer(const char* _title, int _width, int _height)
 
 //-----------------------------------------------------------------------------
 
+InterpolationViewer::~InterpolationViewer()
+{
+    fit_worker_.stop();
+}
+
+//-----------------------------------------------------------------------------
+
+bool InterpolationViewer::load_dataset(const std::string& _filename)
+{
+    std::shared_ptr<Dataset> dataset = std::make_shared<Dataset>();
+    if (!dataset->open(_filename)) return false;
+
+    std::cout << "Loaded " << dataset->size() << " samples ("
+              << (dataset->type() == Dataset::FLOAT32 ? "float" : "double")
+              << ") from " << _filename << std::endl;
+
+    // only draw up to 10000 of the samples
+    const size_t stride = std::max<size_t>(1, dataset->size() / 10000);
+    preview_x_.clear();
+    preview_y_.clear();
+    for (size_t i = 0; i < dataset->size(); i += stride)
+    {
+        Scalar x, y;
+        dataset->sample(i, x, y);
+        preview_x_.push_back(x);
+        preview_y_.push_back(y);
+    }
+
+    cancel_fit();
+    coefficients_.clear();
+    clear_constraints();
+    dataset_ = dataset;
+
+    // no clicked constraint is infinite, and each load gets a new id
+    fingerprint_.add(std::numeric_limits<Scalar>::infinity(), ++dataset_loads_);
+
+    fit_curve();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void InterpolationViewer::close_dataset()
+{
+    // there are no other constraints while a dataset is loaded
+    if (dataset_) fingerprint_.clear();
+
+    // running fits keep their own reference to the mapping
+    dataset_.reset();
+    preview_x_.clear();
+    preview_y_.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+void InterpolationViewer::add_constraint(Scalar _x, Scalar _y)
+{
+    constraints_x_.push_back(_x);
+    constraints_y_.push_back(_y);
+    fingerprint_.add(_x, _y);
+}
+
+//-----------------------------------------------------------------------------
+
+void InterpolationViewer::clear_constraints()
+{
+    constraints_x_.clear();
+    constraints_y_.clear();
+    fingerprint_.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+void InterpolationViewer::rehash_constraints()
+{
+    fingerprint_.clear();
+    for (size_t i = 0; i < constraints_x_.size(); ++i)
+        fingerprint_.add(constraints_x_[i], constraints_y_[i]);
+}
+
+//-----------------------------------------------------------------------------
+
 void InterpolationViewer::keyboard(int key, int code, int action, int mods)
 {
     if (action != GLFW_PRESS && action != GLFW_REPEAT)
@@ -46,6 +143,10 @@ void InterpolationViewer::keyboard(int key, int code, int action, int mods)
             {
                 interpolation_solver_ = LU;
             }
+            else if (interpolation_solver_ == LU)
+            {
+                interpolation_solver_ = LU_AUTO;
+            }
             else
             {
                 interpolation_solver_ = LU_EIGEN;
@@ -58,9 +159,10 @@ void InterpolationViewer::keyboard(int key, int code, int action, int mods)
         // c -> clear points and reset curve
         case GLFW_KEY_C:
         {
+            cancel_fit();
+            close_dataset();
             coefficients_.clear();
-            constraints_x_.clear();
-            constraints_y_.clear();
+            clear_constraints();
             break;
         }
 
@@ -91,16 +193,35 @@ void InterpolationViewer::processImGUI()
         int solver = (int)interpolation_solver_;
         ImGui::RadioButton("Eigen's LU", &solver, 0);
         ImGui::RadioButton("Our LU",     &solver, 1);
+        ImGui::RadioButton("Automatic",  &solver, 2);
         if (solver != interpolation_solver_)
         {
             interpolation_solver_ = (Solver)solver;
             fit_curve();
         }
+
+        show_solver_report();
+
+        if (fit_worker_.busy()) ImGui::Text("Fitting...");
     }
 }
 
 //-----------------------------------------------------------------------------
 
+void InterpolationViewer::show_solver_report() const
+{
+    if (coefficients_.empty()) return;
+
+    if (!solver_path_.empty())
+    {
+        ImGui::TextWrapped("Solver: %s", solver_path_.c_str());
+        ImGui::Text("Condition: %.2e", solver_condition_);
+    }
+    ImGui::Text("Solve time: %.3f ms", solve_time_);
+}
+
+//-----------------------------------------------------------------------------
+
 void InterpolationViewer::mouse(int button, int action, int mods)
 {
     // only on mouse press with left button
@@ -124,8 +245,8 @@ void InterpolationViewer::mouse(int button, int action, int mods)
         if(ox <= 1.0 && ox >= -1.0 && oy < 1.1 && oy > -1.1)
         {
             // add point to interpolation constraints
-            constraints_x_.push_back(ox);
-            constraints_y_.push_back(oy);
+            close_dataset();
+            add_constraint(ox, oy);
 
             // re-compute curve
             fit_curve();
@@ -186,6 +307,18 @@ void InterpolationViewer::display()
     }
     glEnd();
 
+    // draw a subset of the dataset's samples
+    if (!preview_x_.empty())
+    {
+        glPointSize(2.0);
+        glBegin(GL_POINTS);
+        for (unsigned int i = 0; i < preview_x_.size(); ++i)
+        {
+            glVertex2f(preview_x_[i], preview_y_[i]);
+        }
+        glEnd();
+    }
+
     // draw curve (if it has been computed already)
     if (!coefficients_.empty())
     {
@@ -217,13 +350,92 @@ Scalar InterpolationViewer::evaluate_curve(Scalar _x) const
 
 //-----------------------------------------------------------------------------
 
+void InterpolationViewer::doProcessing()
+{
+    // show the latest result of the fitting thread, unless it is outdated
+    std::shared_ptr<const FitResult> result = fit_worker_.result();
+    if (result && result->generation > shown_generation_)
+    {
+        shown_generation_ = result->generation;
+        fit_cache_.insert(result->key, result);
+        accept(*result);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
 void InterpolationViewer::fit_curve()
 {
-    assert(constraints_x_.size() == constraints_y_.size());
+    FitRequest* request = new FitRequest;
+    make_request(*request);
+    request->generation = ++fit_generation_;
+    request->key        = FitCache::key(*request);
+
+    // revisited constraints and settings: no need to fit again
+    std::shared_ptr<const FitResult> cached = fit_cache_.find(request->key);
+    if (cached)
+    {
+        delete request;
+        cancel_fit();
+        accept(*cached);
+        return;
+    }
+
+    fit_worker_.post(request);
+}
+
+//-----------------------------------------------------------------------------
+
+void InterpolationViewer::cancel_fit()
+{
+    fit_worker_.cancel();
+    shown_generation_ = fit_generation_;
+}
+
+//-----------------------------------------------------------------------------
+
+void InterpolationViewer::make_request(FitRequest& _request) const
+{
+    _request.x                    = constraints_x_;
+    _request.y                    = constraints_y_;
+    _request.dataset              = dataset_;
+    _request.fingerprint          = fingerprint_.value();
+    _request.fitting              = 0;
+    _request.interpolation_solver = interpolation_solver_;
+    _request.approximation_solver = 0;
+    _request.degree               = 0;
+    _request.auto_degree          = false;
+    _request.degree_criterion     = 0;
+}
 
-    unsigned int i, j, m = constraints_x_.size();
-    MatrixXX A(m, m);
-    VectorX b(m), x(m);
+//-----------------------------------------------------------------------------
+
+void InterpolationViewer::accept(const FitResult& _result)
+{
+    coefficients_     = _result.coefficients;
+    solver_path_      = _result.solver;
+    solver_condition_ = _result.condition;
+    solve_time_       = _result.solve_time;
+}
+
+//-----------------------------------------------------------------------------
+
+bool InterpolationViewer::fit(const FitRequest& _request, FitResult& _result)
+{
+    assert(_request.x.size() == _request.y.size());
+
+    // an interpolating polynomial of millions of samples is meaningless
+    if (_request.dataset)
+    {
+        std::cerr << "Datasets can only be approximated\n";
+        return true;
+    }
+
+    unsigned int i, j, m = _request.x.size();
+    Workspace::MatrixBlock A = workspace_.matrix(Workspace::SYSTEM, m, m);
+    Workspace::VectorBlock b = workspace_.vector(Workspace::RHS, m);
+    Workspace::VectorBlock x = workspace_.vector(Workspace::SOLUTION, m);
+    Workspace::VectorBlock r = workspace_.vector(Workspace::RESIDUAL, m);
 
     /**
      * Build and solve the system.
@@ -233,25 +445,29 @@ void InterpolationViewer::fit_curve()
      * - Use Eigen's LU solver to solve the system `A * x = b`.
      *   See the function `fullPivLu()` of the matrix `A`.
      * - Compute and print the error `|| A * x - b ||`.
-     * - Depending on `interpolation_solver_`, use our own LU solver instead.
+     * - Depending on `_request.interpolation_solver`, use our own LU solver instead.
      */
 
     // Fill the system's right hand side 'b'
     for (i = 0; i < m; i++) {
-      b(i) = constraints_y_[i];
+      b(i) = _request.y[i];
     }
 
     // Fill matrix 'A'
     for (i = 0; i < m; i++) {
       for (j = 0; j < m ; j++) {
-        A(i, j) = pow(constraints_x_[i], j);
+        A(i, j) = pow(_request.x[i], j);
       }
     }
 
-    if (interpolation_solver_ == LU_EIGEN) {
+    pmp::Timer timer;
+    timer.start();
+
+    if (_request.interpolation_solver == LU_EIGEN) {
       // Use Eigen's LU solver to solve the system 'A * x = b'
       // https://eigen.tuxfamily.org/dox/classEigen_1_1FullPivLU.html#af563471f6f3283fd10779ef02dd0b748
-      x = A.fullPivLu().solve(b);
+      lu_eigen_.compute(A);
+      x = lu_eigen_.solve(b);
 
       /*
       Eigen::FullPivLU<MatrixXX> solver;
@@ -262,19 +478,75 @@ void InterpolationViewer::fit_curve()
       x = solver.solve(b);
       */
 
-      std::cout << "Error: " << (A*x-b).norm() << std::endl;
-
+    } else if (_request.interpolation_solver == LU_AUTO) {
+      if (!solve_automatic(A, b, x, _result)) return false;
     } else {
-      LU_Solver solver_;
-
-      if (solver_.factorize(A)) {
-        solver_.solve(b, x);
+      if (lu_solver_.factorize(A)) {
+        lu_solver_.solve(b, x);
+      }
+      else if (fit_worker_.cancelled()) {
+        return false;
       }
     }
 
+    timer.stop();
+    _result.solve_time = timer.elapsed();
+
+    // residual without temporaries
+    r.noalias() = A * x;
+    r -= b;
+    std::cout << "Error: " << r.norm() << std::endl;
+
     // copy solution to coefficients vector
-    coefficients_.resize(m);
-    for (i = 0; i < m; ++i) coefficients_[i] = x(i);
+    _result.coefficients.resize(m);
+    for (i = 0; i < m; ++i) _result.coefficients[i] = x(i);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool InterpolationViewer::solve_automatic(const Eigen::Ref<const MatrixXX>& _A,
+                                          const Eigen::Ref<const VectorX>& _b,
+                                          Eigen::Ref<VectorX> _x,
+                                          FitResult& _result)
+{
+    const int n = _A.rows();
+    Workspace::VectorBlock u = workspace_.vector(Workspace::ESTIMATE_X, n);
+    Workspace::VectorBlock v = workspace_.vector(Workspace::ESTIMATE_Y, n);
+
+    // partial pivoting is as stable as full pivoting in practice, at a
+    // fraction of the cost. The estimate reuses its factors in O(n^2).
+    partial_lu_eigen_.compute(_A);
+    _result.solver    = "partial-pivoting LU";
+    _result.condition = condition_estimate(
+        norm1(_A),
+        [this](const Eigen::Ref<const VectorX>& _in, Eigen::Ref<VectorX> _out) {
+            _out = partial_lu_eigen_.solve(_in);
+        },
+        [this](const Eigen::Ref<const VectorX>& _in, Eigen::Ref<VectorX> _out) {
+            _out = partial_lu_eigen_.transpose().solve(_in);
+        },
+        u, v);
+
+    if (is_well_conditioned(_result.condition))
+    {
+        _x = partial_lu_eigen_.solve(_b);
+    }
+    else
+    {
+        if (fit_worker_.cancelled()) return false;
+
+        // nearly singular: full pivoting also detects the numerical rank
+        lu_eigen_.compute(_A);
+        _x = lu_eigen_.solve(_b);
+        _result.solver += " -> full-pivoting LU";
+    }
+
+    std::cout << "Automatic solver: " << _result.solver << " (condition "
+              << _result.condition << ")\n";
+
+    return true;
 }
 
 //=============================================================================
@@ -12,6 +12,9 @@
 
 #include <pmp/Window.h>
 #include "lu.h"
+#include "workspace.h"
+#include "fit_worker.h"
+#include "fit_cache.h"
 #include <vector>
 
 
@@ -25,6 +28,12 @@ public:
     /// constructor
     InterpolationViewer(const char* _title, int _width, int _height);
 
+    /// destructor, stops the fitting thread
+    virtual ~InterpolationViewer();
+
+    /// use the samples of a dataset file as constraints
+    virtual bool load_dataset(const std::string& _filename);
+
 protected:
 
     /// render/handle GUI
@@ -39,16 +48,60 @@ protected:
     /// this function is called when the scene has to be rendered.
     virtual void display() override;
 
-    /// fit a polynomial curve to constraints
-    virtual void fit_curve();
+    /// this function picks up the results of the fitting thread
+    virtual void doProcessing() override;
+
+    /// fit a polynomial curve to constraints (in the background)
+    void fit_curve();
+
+    /// drop pending and running fits, e.g. when the constraints are cleared
+    void cancel_fit();
+
+    /// store the current constraints and settings in _request
+    virtual void make_request(FitRequest& _request) const;
+
+    /// fit a polynomial curve as requested. Runs on the fitting thread and
+    /// returns false if it got cancelled.
+    virtual bool fit(const FitRequest& _request, FitResult& _result);
+
+    /// show the result of a fit
+    virtual void accept(const FitResult& _result);
+
+    /// Solve _A * _x = _b with partial-pivoting LU, and escalate to
+    /// full-pivoting LU only if the estimated condition number demands it.
+    /// Returns false if the fit got cancelled.
+    bool solve_automatic(const Eigen::Ref<const MatrixXX>& _A,
+                         const Eigen::Ref<const VectorX>& _b,
+                         Eigen::Ref<VectorX> _x, FitResult& _result);
+
+    /// show which solver was used and what it cost
+    void show_solver_report() const;
 
     /// evaluate the polynomial specified by coefficients_
     Scalar evaluate_curve(Scalar _x) const;
 
+    /// go back to interactive constraints
+    void close_dataset();
+
+    /// append a constraint, updating the fingerprint
+    void add_constraint(Scalar _x, Scalar _y);
+
+    /// remove all constraints
+    void clear_constraints();
+
+    /// recompute the fingerprint after the constraints were modified in place
+    void rehash_constraints();
+
+    /// number of constraints (clicked or from the dataset)
+    size_t n_constraints() const
+    {
+        return dataset_ ? dataset_->size() : constraints_x_.size();
+    }
+
 protected:
 
     /// which solver to use?
-    enum Solver { LU_EIGEN=0, LU=1 } interpolation_solver_;
+    enum Solver { LU_EIGEN=0, LU=1, LU_AUTO=2 } interpolation_solver_;
 
     /// x-coordinates of constraints
     std::vector<Scalar> constraints_x_;
@@ -58,6 +111,44 @@ protected:
 
     /// coefficients of the polynomial
     std::vector<Scalar> coefficients_;
+
+    /// solver report of the shown fit
+    std::string solver_path_;
+    Scalar      solver_condition_;
+    double      solve_time_;
+
+    /// fingerprint of the constraints (or of the loaded dataset)
+    ConstraintFingerprint fingerprint_;
+
+    /// number of datasets loaded so far, to tell them apart
+    unsigned long dataset_loads_;
+
+    /// results of recent fits, to answer revisited settings immediately
+    FitCache fit_cache_;
+
+    /// memory-mapped constraints, if a dataset is loaded
+    std::shared_ptr<const Dataset> dataset_;
+
+    /// subset of the dataset's samples that is drawn
+    std::vector<Scalar> preview_x_, preview_y_;
+
+    /// background thread doing the fits
+    FitWorker fit_worker_;
+
+    /// generation of the latest request and of the shown result
+    unsigned long fit_generation_, shown_generation_;
+
+    /// buffers of the fitting pipeline, kept across fits (fitting thread only)
+    Workspace workspace_;
+
+    /// our LU solver, kept to reuse its factor buffers
+    LU_Solver lu_solver_;
+
+    /// Eigen's LU solver, kept to reuse its factor buffers
+    Eigen::FullPivLU<MatrixXX> lu_eigen_;
+
+    /// Eigen's partial-pivoting LU, the first choice of the automatic solver
+    Eigen::PartialPivLU<MatrixXX> partial_lu_eigen_;
 };
 
 //=============================================================================
@@ -15,6 +15,11 @@
 int main(int argc, char **argv)
 {
     ApproximationViewer viewer("Curve Approximation", 800, 600);
+
+    // optionally approximate the samples of a dataset file
+    if (argc > 1 && !viewer.load_dataset(argv[1]))
+        return EXIT_FAILURE;
+
     return viewer.run();
 }
 
@@ -14,16 +14,16 @@
 
 //== CLASS DEFINITION =========================================================
 
-bool CholeskySolver::factorize(const MatrixXX& A)
+bool CholeskySolver::factorize(const Eigen::Ref<const MatrixXX>& A)
 {
   assert(A.rows() == A.cols());
 
   int i, j, k;
   const int m = A.rows();
 
-  // initialize L
-  L.resize(m, m);
-  L.setZero();
+  // initialize L (grow-only, work on the leading m x m block)
+  n_ = m;
+  Workspace::reserve(L, m, m);
 
   /**
    * Compute the Cholesky factorization, i.e., compute the matrix `L`.
@@ -34,7 +34,7 @@ bool CholeskySolver::factorize(const MatrixXX& A)
    */
 
   // Initialise L with A
-  L = A;
+  L.topLeftCorner(m, m) = A;
 
   // set upper triangle of L to zero
   for (i = 0; i < m; i++) {
@@ -45,6 +45,9 @@ bool CholeskySolver::factorize(const MatrixXX& A)
 
   for (k = 0; k < m; k++)
   {
+    // stop early if the result is not needed anymore
+    if (cancel && cancel()) return false;
+
     const Scalar diag = L(k, k);
 
     /*
@@ -66,19 +69,25 @@ bool CholeskySolver::factorize(const MatrixXX& A)
   }
 
   // check error of factorization
-  std::cout << "  error(A=L*L^T) : " << (A - L * L.transpose()).norm()
-            << std::endl;
+  if (verbose)
+    std::cout << "  error(A=L*L^T) : "
+              << (A - L.topLeftCorner(m, m) *
+                          L.topLeftCorner(m, m).transpose())
+                     .norm()
+              << std::endl;
 
   return true;
 }
 
 //-----------------------------------------------------------------------------
 
-void CholeskySolver::solve(const VectorX& _b, VectorX& _x)
+void CholeskySolver::solve(const Eigen::Ref<const VectorX>& _b,
+                           Eigen::Ref<VectorX> _x)
 {
   // use LU's solve function with U = L^T
   // Note: If memory was limited, this would not be recommended.
-  U = L.transpose();
+  Workspace::reserve(U, n_, n_);
+  U.topLeftCorner(n_, n_) = L.topLeftCorner(n_, n_).transpose();
   LU_Solver::solve(_b, _x);
 }
 
@@ -25,10 +25,10 @@ public:
     CholeskySolver() {}
 
     /// factorize matrix A=L*L^T
-    virtual bool factorize(const MatrixXX& _A) override;
+    virtual bool factorize(const Eigen::Ref<const MatrixXX>& _A) override;
 
     /// solve A*x=b
-    virtual void solve(const VectorX& _b, VectorX& _x) override;
+    virtual void solve(const Eigen::Ref<const VectorX>& _b, Eigen::Ref<VectorX> _x) override;
 };
 
 //=============================================================================
@@ -0,0 +1,93 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "condition.h"
+
+#include <cmath>
+
+//== IMPLEMENTATION ===========================================================
+
+Scalar norm1(const Eigen::Ref<const MatrixXX>& _A)
+{
+  Scalar norm = 0.0;
+  for (int j = 0; j < _A.cols(); ++j)
+    norm = std::max(norm, _A.col(j).cwiseAbs().sum());
+  return norm;
+}
+
+//-----------------------------------------------------------------------------
+
+Scalar upper_norm1(const Eigen::Ref<const MatrixXX>& _A)
+{
+  Scalar norm = 0.0;
+  for (int j = 0; j < _A.cols(); ++j)
+  {
+    const int k = std::min<int>(j + 1, _A.rows());
+    norm = std::max(norm, _A.col(j).head(k).cwiseAbs().sum());
+  }
+  return norm;
+}
+
+//-----------------------------------------------------------------------------
+
+Scalar inverse_norm1(const Solve_function& _solve,
+                     const Solve_function& _solve_transposed,
+                     Eigen::Ref<VectorX> _x, Eigen::Ref<VectorX> _y)
+{
+  assert(_x.rows() == _y.rows());
+
+  const int n        = _x.rows();
+  const int max_iter = 5;
+  int       i, iter, j = -1;
+  Scalar    estimate = 0.0;
+
+  if (n == 0) return 0.0;
+
+  // start with x = (1/n, ..., 1/n)
+  _x.setConstant(1.0 / n);
+
+  for (iter = 0; iter < max_iter; ++iter)
+  {
+    // y = M^-1 x, its 1-norm is a lower bound of ||M^-1||_1
+    _solve(_x, _y);
+    const Scalar new_estimate = _y.cwiseAbs().sum();
+    if (!std::isfinite(new_estimate)) return new_estimate;
+
+    // no progress (Higham): stop
+    if (iter > 0 && new_estimate <= estimate) break;
+    estimate = new_estimate;
+
+    // z = M^-T sign(y), the subgradient of ||M^-1 x||_1
+    for (i = 0; i < n; ++i) _x(i) = (_y(i) >= 0.0 ? 1.0 : -1.0);
+    _solve_transposed(_x, _y);
+
+    // converged if no unit vector promises a larger value than the current
+    // x = e_j (Hager: ||z||_inf <= z^T x = z_j), or the best one is e_j again
+    int          jmax;
+    const Scalar zmax = _y.cwiseAbs().maxCoeff(&jmax);
+    if (iter > 0 && (jmax == j || zmax <= _y(j))) break;
+
+    // continue with the most promising unit vector
+    j = jmax;
+    _x.setZero();
+    _x(j) = 1.0;
+  }
+
+  // Higham's alternative vector guards against the rare bad cases
+  // of Hager's method
+  for (i = 0; i < n; ++i)
+    _x(i) = (i % 2 ? -1.0 : 1.0) * (1.0 + Scalar(i) / std::max(n - 1, 1));
+  _solve(_x, _y);
+  const Scalar alternative = 2.0 * _y.cwiseAbs().sum() / (3.0 * n);
+
+  return std::max(estimate, alternative);
+}
+
+//=============================================================================
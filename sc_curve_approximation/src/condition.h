@@ -0,0 +1,58 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include "types.h"
+
+//== CLASS DEFINITION =========================================================
+
+/// computes _out = M^-1 * _in (or M^-T * _in) from a factorization of M
+typedef std::function<void(const Eigen::Ref<const VectorX>& _in,
+                           Eigen::Ref<VectorX> _out)>
+    Solve_function;
+
+/// 1-norm (maximum absolute column sum) of _A
+Scalar norm1(const Eigen::Ref<const MatrixXX>& _A);
+
+/// 1-norm of the upper triangle of _A
+Scalar upper_norm1(const Eigen::Ref<const MatrixXX>& _A);
+
+/// Estimate ||M^-1||_1 of an n x n matrix M from an existing factorization,
+/// using Hager's method with Higham's refinements (as in LAPACK's xLACON).
+/// It only needs a few solves with M and M^T, i.e. O(n^2) instead of the
+/// O(n^3) of computing the inverse. The estimate is a lower bound that is
+/// almost always within a factor of 3 of the true norm. _x and _y are
+/// scratch vectors of size n.
+Scalar inverse_norm1(const Solve_function& _solve,
+                     const Solve_function& _solve_transposed,
+                     Eigen::Ref<VectorX> _x, Eigen::Ref<VectorX> _y);
+
+/// estimate the 1-norm condition number ||M||_1 * ||M^-1||_1 of M
+inline Scalar condition_estimate(Scalar _norm1, const Solve_function& _solve,
+                                 const Solve_function& _solve_transposed,
+                                 Eigen::Ref<VectorX> _x,
+                                 Eigen::Ref<VectorX> _y)
+{
+    return _norm1 * inverse_norm1(_solve, _solve_transposed, _x, _y);
+}
+
+/// Is a solve with condition number _condition accurate enough? Its
+/// relative error is bounded by about _condition * eps, and we ask for at
+/// least half of the available digits, i.e. _condition <= 1/sqrt(eps).
+inline bool is_well_conditioned(Scalar _condition)
+{
+    return _condition <= 1.0 / sqrt(std::numeric_limits<Scalar>::epsilon());
+}
+
+//=============================================================================
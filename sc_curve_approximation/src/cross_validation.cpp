@@ -0,0 +1,67 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "cross_validation.h"
+
+#include <cmath>
+
+//== IMPLEMENTATION ===========================================================
+
+bool cross_validation(const Eigen::Ref<const MatrixXX>& _A,
+                      const Eigen::Ref<const VectorX>& _b,
+                      const Eigen::Ref<const VectorX>& _x,
+                      const Eigen::Ref<const MatrixXX>& _L,
+                      Eigen::Ref<VectorX> _w, CrossValidation& _cv)
+{
+  assert(_A.rows() == _b.rows() && _A.cols() == _x.rows());
+  assert(_L.rows() == _A.cols() && _L.cols() == _A.cols());
+  assert(_w.rows() == _A.cols());
+
+  int i, j, k;
+  const int m = _A.rows();
+  const int n = _A.cols();
+
+  Scalar loo = 0.0, rss = 0.0, trace = 0.0;
+
+  for (i = 0; i < m; ++i)
+  {
+    // the hat matrix is H = A (A^T A)^-1 A^T = W^T W with W = L^-1 A^T,
+    // so h_ii is the squared norm of w = L^-1 a_i (forward substitution)
+    Scalar h = 0.0;
+    for (j = 0; j < n; ++j)
+    {
+      Scalar sum = _A(i, j);
+      for (k = 0; k < j; ++k) sum -= _L(j, k) * _w(k);
+      _w(j) = sum / _L(j, j);
+      h += _w(j) * _w(j);
+    }
+
+    // residual of the full fit
+    const Scalar r = _b(i) - _A.row(i).dot(_x);
+
+    // leave-one-out residual of sample i is r_i / (1 - h_ii)
+    const Scalar d = 1.0 - h;
+    if (d < 1e-10) return false;
+    loo += (r / d) * (r / d);
+    rss += r * r;
+    trace += h;
+  }
+
+  // GCV replaces the individual leverages by their mean trace(H) / m
+  const Scalar d = m - trace;
+  if (d < 1e-10) return false;
+
+  _cv.loo = loo / m;
+  _cv.gcv = m * rss / (d * d);
+
+  return std::isfinite(_cv.loo) && std::isfinite(_cv.gcv);
+}
+
+//=============================================================================
@@ -0,0 +1,39 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include "types.h"
+
+//== CLASS DEFINITION =========================================================
+
+/// cross-validation scores of a least squares fit
+struct CrossValidation
+{
+    /// mean squared leave-one-out residual
+    Scalar loo;
+
+    /// generalized cross-validation score
+    Scalar gcv;
+};
+
+/// Compute the exact leave-one-out and GCV scores of the least squares
+/// solution `_x` of `_A * _x = _b` without refitting. `_L` is the Cholesky
+/// factor of the normal equations, `A^T*A = L*L^T`, which gives the diagonal
+/// of the hat matrix in O(m*n^2). `_w` is a scratch vector of size n.
+/// Returns false if a sample has leverage one, i.e. the fit cannot be
+/// evaluated without it.
+bool cross_validation(const Eigen::Ref<const MatrixXX>& _A,
+                      const Eigen::Ref<const VectorX>& _b,
+                      const Eigen::Ref<const VectorX>& _x,
+                      const Eigen::Ref<const MatrixXX>& _L,
+                      Eigen::Ref<VectorX> _w, CrossValidation& _cv);
+
+//=============================================================================
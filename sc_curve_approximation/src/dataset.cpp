@@ -0,0 +1,420 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "dataset.h"
+
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//== IMPLEMENTATION ===========================================================
+
+static_assert(sizeof(Dataset::Header) == Dataset::ALIGNMENT,
+              "dataset header has to fill one aligned block");
+
+namespace {
+
+const char MAGIC[8] = "SCCURVE";
+
+//-----------------------------------------------------------------------------
+
+/// add the power sums sum(x^k), k<=2*_degree, and sum(y*x^k), k<=_degree,
+/// of _n samples to _sx and _sy
+template <typename Real>
+void power_sums(const Real* _x, const Real* _y, size_t _n, int _degree,
+                Scalar* _sx, Scalar* _sy)
+{
+  for (size_t i = 0; i < _n; ++i)
+  {
+    const Scalar x = _x[i], y = _y[i];
+    Scalar       p = 1.0;
+    for (int k = 0; k <= _degree; ++k, p *= x)
+    {
+      _sx[k] += p;
+      _sy[k] += y * p;
+    }
+    for (int k = _degree + 1; k <= 2 * _degree; ++k, p *= x) _sx[k] += p;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+/// sum of squared residuals of _n samples w.r.t. the polynomial _coeffs
+template <typename Real>
+Scalar squared_residual(const Real* _x, const Real* _y, size_t _n,
+                        const Eigen::Ref<const VectorX>& _coeffs)
+{
+  const int n   = _coeffs.size();
+  Scalar    sum = 0.0;
+  for (size_t i = 0; i < _n; ++i)
+  {
+    // Horner scheme
+    Scalar value = 0.0;
+    for (int k = n - 1; k >= 0; --k) value = value * _x[i] + _coeffs(k);
+    sum += (value - _y[i]) * (value - _y[i]);
+  }
+  return sum;
+}
+
+} // anonymous namespace
+
+//-----------------------------------------------------------------------------
+
+Dataset::Dataset() : data_(nullptr), bytes_(0)
+{
+#ifdef _WIN32
+  file_ = mapping_ = nullptr;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+Dataset::~Dataset()
+{
+  close();
+}
+
+//-----------------------------------------------------------------------------
+
+size_t Dataset::column_bytes(Type _type, size_t _n)
+{
+  const size_t bytes = _n * value_bytes(_type);
+  return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+//-----------------------------------------------------------------------------
+
+size_t Dataset::column_bytes() const
+{
+  return column_bytes(type(), header().chunk_size);
+}
+
+//-----------------------------------------------------------------------------
+
+size_t Dataset::n_chunks() const
+{
+  const size_t chunk_size = header().chunk_size;
+  return (size() + chunk_size - 1) / chunk_size;
+}
+
+//-----------------------------------------------------------------------------
+
+size_t Dataset::chunk_length(size_t _c) const
+{
+  const size_t chunk_size = header().chunk_size;
+  return std::min(chunk_size, size() - _c * chunk_size);
+}
+
+//-----------------------------------------------------------------------------
+
+bool Dataset::open(const std::string& _filename)
+{
+  close();
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(_filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    std::cerr << "Dataset: cannot open " << _filename << std::endl;
+    return false;
+  }
+  LARGE_INTEGER size;
+  GetFileSizeEx(file, &size);
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  const void* data =
+      mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+  if (!data)
+  {
+    std::cerr << "Dataset: cannot map " << _filename << std::endl;
+    if (mapping) CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+  file_    = file;
+  mapping_ = mapping;
+  bytes_   = size.QuadPart;
+#else
+  int fd = ::open(_filename.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    std::cerr << "Dataset: cannot open " << _filename << std::endl;
+    return false;
+  }
+  struct stat st;
+  fstat(fd, &st);
+  void* data = st.st_size > 0 ? mmap(nullptr, st.st_size, PROT_READ,
+                                     MAP_SHARED, fd, 0)
+                              : MAP_FAILED;
+  ::close(fd);  // the mapping stays valid
+  if (data == MAP_FAILED)
+  {
+    std::cerr << "Dataset: cannot map " << _filename << std::endl;
+    return false;
+  }
+  // samples are read once, front to back
+  madvise(data, st.st_size, MADV_SEQUENTIAL);
+  bytes_ = st.st_size;
+#endif
+
+  data_ = static_cast<const char*>(data);
+
+  // check header and file size
+  if (bytes_ < sizeof(Header) || memcmp(header().magic, MAGIC, 8) != 0 ||
+      header().version != VERSION || header().type > FLOAT32 ||
+      header().chunk_size == 0)
+  {
+    std::cerr << "Dataset: " << _filename << " is not a dataset file\n";
+    close();
+    return false;
+  }
+  // The file must hold the padded x-column of the last chunk and its
+  // samples, after 2 * last padded columns. The header fields may be
+  // anything, so the file size is divided instead of the fields being
+  // multiplied, which could overflow.
+  bool complete = true;
+  if (size())
+  {
+    const size_t chunk_size = header().chunk_size;
+    const size_t payload    = bytes_ - sizeof(Header);
+    complete = (chunk_size <= payload / value_bytes(type()));
+    if (complete)
+    {
+      // column_bytes() is at most payload + ALIGNMENT now
+      const size_t column = column_bytes();
+      const size_t last   = size() / chunk_size - (size() % chunk_size == 0);
+      const size_t tail   = column + chunk_length(last) * value_bytes(type());
+      complete = (tail <= payload && last <= (payload - tail) / (2 * column));
+    }
+  }
+  if (!complete)
+  {
+    std::cerr << "Dataset: " << _filename << " is truncated\n";
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void Dataset::close()
+{
+  if (!data_) return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(data_);
+  CloseHandle((HANDLE)mapping_);
+  CloseHandle((HANDLE)file_);
+  file_ = mapping_ = nullptr;
+#else
+  munmap(const_cast<char*>(data_), bytes_);
+#endif
+
+  data_  = nullptr;
+  bytes_ = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void Dataset::sample(size_t _i, Scalar& _x, Scalar& _y) const
+{
+  assert(_i < size());
+
+  const size_t c = _i / header().chunk_size;
+  const size_t i = _i % header().chunk_size;
+  if (type() == FLOAT32)
+  {
+    _x = x<float>(c)[i];
+    _y = y<float>(c)[i];
+  }
+  else
+  {
+    _x = x<double>(c)[i];
+    _y = y<double>(c)[i];
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void Dataset::normal_equations(int _degree, Eigen::Ref<MatrixXX> _AtA,
+                               Eigen::Ref<VectorX> _Atb) const
+{
+  const int n = _degree + 1;
+  assert(_AtA.rows() == n && _AtA.cols() == n && _Atb.rows() == n);
+
+  // for monomials, (A^T A)_jk = sum x^(j+k) and (A^T b)_j = sum y x^j,
+  // so the normal equations only need 3n-1 power sums (one pass, O(m*n)).
+  // Summing per chunk first keeps the round-off of long sums small.
+  std::vector<Scalar> sx(2 * n - 1, 0.0), sy(n, 0.0);
+  std::vector<Scalar> cx(2 * n - 1), cy(n);
+
+  for (size_t c = 0; c < n_chunks(); ++c)
+  {
+    std::fill(cx.begin(), cx.end(), 0.0);
+    std::fill(cy.begin(), cy.end(), 0.0);
+
+    if (type() == FLOAT32)
+      power_sums(x<float>(c), y<float>(c), chunk_length(c), _degree, &cx[0],
+                 &cy[0]);
+    else
+      power_sums(x<double>(c), y<double>(c), chunk_length(c), _degree, &cx[0],
+                 &cy[0]);
+
+    for (int k = 0; k < 2 * n - 1; ++k) sx[k] += cx[k];
+    for (int k = 0; k < n; ++k) sy[k] += cy[k];
+  }
+
+  for (int j = 0; j < n; ++j)
+  {
+    for (int k = 0; k < n; ++k) _AtA(j, k) = sx[j + k];
+    _Atb(j) = sy[j];
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+Scalar Dataset::squared_residual(const Eigen::Ref<const VectorX>& _coeffs) const
+{
+  Scalar sum = 0.0;
+  for (size_t c = 0; c < n_chunks(); ++c)
+  {
+    if (type() == FLOAT32)
+      sum += ::squared_residual(x<float>(c), y<float>(c), chunk_length(c),
+                                _coeffs);
+    else
+      sum += ::squared_residual(x<double>(c), y<double>(c), chunk_length(c),
+                                _coeffs);
+  }
+  return sum;
+}
+
+//=============================================================================
+
+DatasetWriter::DatasetWriter() : file_(nullptr), count_(0) {}
+
+//-----------------------------------------------------------------------------
+
+DatasetWriter::~DatasetWriter()
+{
+  close();
+}
+
+//-----------------------------------------------------------------------------
+
+bool DatasetWriter::open(const std::string& _filename, Dataset::Type _type,
+                         size_t _chunk_size)
+{
+  close();
+
+  file_ = fopen(_filename.c_str(), "wb");
+  if (!file_)
+  {
+    std::cerr << "DatasetWriter: cannot open " << _filename << std::endl;
+    return false;
+  }
+
+  type_       = _type;
+  chunk_size_ = std::max<size_t>(_chunk_size, 1);
+  count_      = 0;
+  x_.clear();
+  y_.clear();
+
+  // placeholder, the final header is written by close()
+  Dataset::Header header;
+  memset(&header, 0, sizeof(header));
+  return fwrite(&header, sizeof(header), 1, file_) == 1;
+}
+
+//-----------------------------------------------------------------------------
+
+bool DatasetWriter::add(Scalar _x, Scalar _y)
+{
+  assert(file_);
+
+  x_.push_back(_x);
+  y_.push_back(_y);
+  ++count_;
+
+  return x_.size() < chunk_size_ || flush();
+}
+
+//-----------------------------------------------------------------------------
+
+bool DatasetWriter::flush()
+{
+  const size_t n     = x_.size();
+  const size_t bytes = Dataset::column_bytes(type_, chunk_size_);
+  std::vector<char> column(bytes);
+
+  bool ok = true;
+  for (int col = 0; col < 2; ++col)
+  {
+    const std::vector<Scalar>& values = (col == 0 ? x_ : y_);
+
+    std::fill(column.begin(), column.end(), 0);
+    for (size_t i = 0; i < n; ++i)
+    {
+      if (type_ == Dataset::FLOAT32)
+        reinterpret_cast<float*>(&column[0])[i] = values[i];
+      else
+        reinterpret_cast<double*>(&column[0])[i] = values[i];
+    }
+
+    // the x-column is always padded to the full chunk size
+    const size_t used =
+        (col == 0 ? bytes : Dataset::column_bytes(type_, n));
+    ok = ok && fwrite(&column[0], 1, used, file_) == used;
+  }
+
+  x_.clear();
+  y_.clear();
+  return ok;
+}
+
+//-----------------------------------------------------------------------------
+
+bool DatasetWriter::close()
+{
+  if (!file_) return false;
+
+  // a single chunk does not need to be padded to the requested chunk size
+  if (count_ == x_.size() && count_ > 0) chunk_size_ = count_;
+
+  bool ok = x_.empty() || flush();
+
+  Dataset::Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MAGIC, 8);
+  header.version    = Dataset::VERSION;
+  header.type       = type_;
+  header.count      = count_;
+  header.chunk_size = chunk_size_;
+
+  ok = ok && fseek(file_, 0, SEEK_SET) == 0 &&
+       fwrite(&header, sizeof(header), 1, file_) == 1;
+  ok = (fclose(file_) == 0) && ok;
+  file_ = nullptr;
+
+  return ok;
+}
+
+//=============================================================================
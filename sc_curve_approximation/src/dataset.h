@@ -0,0 +1,183 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "types.h"
+
+//== CLASS DEFINITION =========================================================
+
+/// Columnar binary file of (x, y) samples, memory-mapped for reading.
+///
+/// The file starts with a 64 byte Header, followed by chunks of
+/// `chunk_size` samples. Each chunk stores all its x-coordinates, then all
+/// its y-coordinates, and each column is padded to 64 bytes. Only the last
+/// chunk may hold fewer samples. Values are stored as double or float in
+/// little-endian byte order.
+class Dataset
+{
+public:
+
+    /// storage type of the samples
+    enum Type
+    {
+        FLOAT64=0,
+        FLOAT32=1
+    };
+
+    /// file header
+    struct Header
+    {
+        char     magic[8];   ///< "SCCURVE" plus terminating zero
+        uint32_t version;    ///< format version
+        uint32_t type;       ///< see Type
+        uint64_t count;      ///< number of samples
+        uint64_t chunk_size; ///< samples per chunk
+        uint8_t  reserved[32];
+    };
+
+    /// file format version
+    static const uint32_t VERSION = 1;
+
+    /// alignment of header and columns in bytes
+    static const size_t ALIGNMENT = 64;
+
+    /// constructor
+    Dataset();
+
+    /// destructor, unmaps the file
+    ~Dataset();
+
+    /// map the file _filename, returns false on failure
+    bool open(const std::string& _filename);
+
+    /// unmap the file
+    void close();
+
+    /// is a file mapped?
+    bool is_open() const { return data_ != nullptr; }
+
+    /// storage type
+    Type type() const { return (Type)header().type; }
+
+    /// number of samples
+    size_t size() const { return header().count; }
+
+    /// number of chunks
+    size_t n_chunks() const;
+
+    /// number of samples in chunk _c
+    size_t chunk_length(size_t _c) const;
+
+    /// x-coordinates of chunk _c; Real has to match type()
+    template <typename Real>
+    const Real* x(size_t _c) const
+    {
+        return reinterpret_cast<const Real*>(data_ + chunk_offset(_c));
+    }
+
+    /// y-coordinates of chunk _c; Real has to match type()
+    template <typename Real>
+    const Real* y(size_t _c) const
+    {
+        return reinterpret_cast<const Real*>(data_ + chunk_offset(_c) +
+                                             column_bytes());
+    }
+
+    /// x- and y-coordinate of sample _i (slow, for previews)
+    void sample(size_t _i, Scalar& _x, Scalar& _y) const;
+
+    /// accumulate the normal equations `A^T*A`, `A^T*b` of the least squares
+    /// polynomial fit of degree _degree in a single pass over the samples
+    void normal_equations(int _degree, Eigen::Ref<MatrixXX> _AtA,
+                          Eigen::Ref<VectorX> _Atb) const;
+
+    /// squared residual norm of the polynomial with coefficients _coeffs
+    Scalar squared_residual(const Eigen::Ref<const VectorX>& _coeffs) const;
+
+    /// bytes per value of storage type _type
+    static size_t value_bytes(Type _type) { return _type == FLOAT32 ? 4 : 8; }
+
+    /// bytes of a padded column of _n values of type _type
+    static size_t column_bytes(Type _type, size_t _n);
+
+private:
+
+    const Header& header() const
+    {
+        return *reinterpret_cast<const Header*>(data_);
+    }
+
+    /// bytes of a padded column of this file
+    size_t column_bytes() const;
+
+    /// offset of chunk _c from the beginning of the file
+    size_t chunk_offset(size_t _c) const
+    {
+        return sizeof(Header) + _c * 2 * column_bytes();
+    }
+
+private:
+
+    /// mapped file
+    const char* data_;
+    size_t      bytes_;
+
+#ifdef _WIN32
+    void* file_;
+    void* mapping_;
+#endif
+};
+
+//-----------------------------------------------------------------------------
+
+/// Writes a Dataset file sample by sample, one chunk at a time.
+class DatasetWriter
+{
+public:
+
+    /// constructor
+    DatasetWriter();
+
+    /// destructor, finishes the file
+    ~DatasetWriter();
+
+    /// start writing _filename, returns false on failure
+    bool open(const std::string& _filename,
+              Dataset::Type _type = Dataset::FLOAT64,
+              size_t _chunk_size = 1 << 16);
+
+    /// append a sample
+    bool add(Scalar _x, Scalar _y);
+
+    /// write the last chunk and the final header
+    bool close();
+
+    /// number of samples written so far
+    size_t size() const { return count_; }
+
+private:
+
+    /// write the buffered (possibly partial) chunk
+    bool flush();
+
+private:
+
+    FILE*               file_;
+    Dataset::Type       type_;
+    size_t              chunk_size_, count_;
+    std::vector<Scalar> x_, y_;
+};
+
+//=============================================================================
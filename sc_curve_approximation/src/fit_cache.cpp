@@ -0,0 +1,82 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "fit_cache.h"
+
+//== IMPLEMENTATION ===========================================================
+
+uint64_t FitCache::key(const FitRequest& _request)
+{
+  // settings a fit does not depend on must not change the key, e.g. the
+  // degree for interpolation, or for automatic degree selection
+  const bool interpolate = (_request.fitting == 0);
+  const int  settings[]  = {
+      _request.fitting,
+      interpolate ? _request.interpolation_solver
+                  : _request.approximation_solver,
+      interpolate || _request.auto_degree ? -1 : _request.degree,
+      !interpolate && _request.auto_degree,
+      !interpolate && _request.auto_degree ? _request.degree_criterion : -1};
+
+  uint64_t key = _request.fingerprint;
+  for (int setting : settings)
+    key = ConstraintFingerprint::mix(key ^ uint64_t(uint32_t(setting)));
+  return key;
+}
+
+//-----------------------------------------------------------------------------
+
+std::shared_ptr<const FitResult> FitCache::find(uint64_t _key)
+{
+  auto it = index_.find(_key);
+  if (it == index_.end())
+  {
+    ++misses_;
+    return std::shared_ptr<const FitResult>();
+  }
+
+  // move to the front
+  entries_.splice(entries_.begin(), entries_, it->second);
+  ++hits_;
+  return it->second->second;
+}
+
+//-----------------------------------------------------------------------------
+
+void FitCache::insert(uint64_t _key,
+                      const std::shared_ptr<const FitResult>& _result)
+{
+  auto it = index_.find(_key);
+  if (it != index_.end())
+  {
+    it->second->second = _result;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return;
+  }
+
+  entries_.push_front(Entry(_key, _result));
+  index_[_key] = entries_.begin();
+
+  if (entries_.size() > capacity_)
+  {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void FitCache::clear()
+{
+  entries_.clear();
+  index_.clear();
+}
+
+//=============================================================================
@@ -0,0 +1,125 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include "types.h"
+#include "fit_worker.h"
+
+//== CLASS DEFINITION =========================================================
+
+/// Order-dependent 64 bit hash of a sequence of constraints. Appending a
+/// constraint updates it in O(1).
+class ConstraintFingerprint
+{
+public:
+
+    /// fingerprint of the empty sequence
+    ConstraintFingerprint() { clear(); }
+
+    /// start over with the empty sequence
+    void clear() { hash_ = 0xcbf29ce484222325ull; }
+
+    /// append constraint (_x, _y)
+    void add(Scalar _x, Scalar _y)
+    {
+        hash_ = (hash_ ^ mix(bits(_x))) * 0x100000001b3ull;
+        hash_ = (hash_ ^ mix(bits(_y))) * 0x100000001b3ull;
+    }
+
+    /// the current fingerprint
+    uint64_t value() const { return hash_; }
+
+    /// spread the bits of _v over the whole word (splitmix64 finalizer)
+    static uint64_t mix(uint64_t _v)
+    {
+        _v = (_v ^ (_v >> 30)) * 0xbf58476d1ce4e5b9ull;
+        _v = (_v ^ (_v >> 27)) * 0x94d049bb133111ebull;
+        return _v ^ (_v >> 31);
+    }
+
+private:
+
+    /// bit pattern of _s, with -0 and +0 identified
+    static uint64_t bits(Scalar _s)
+    {
+        double   d = (_s == 0.0 ? 0.0 : double(_s));
+        uint64_t b;
+        memcpy(&b, &d, sizeof(b));
+        return b;
+    }
+
+private:
+
+    uint64_t hash_;
+};
+
+//-----------------------------------------------------------------------------
+
+/// Least recently used cache of fit results.
+///
+/// A result is found by a 64 bit key of the constraints' fingerprint and
+/// every setting the fit depends on (see key()). Changing the constraints
+/// changes the fingerprint, so stale entries are never hit; they are just
+/// evicted once they are the least recently used. Only the GUI thread may
+/// use the cache.
+class FitCache
+{
+public:
+
+    /// constructor
+    explicit FitCache(size_t _capacity = 64)
+        : capacity_(_capacity), hits_(0), misses_(0)
+    {
+    }
+
+    /// key of _request, from its fingerprint and the settings that matter
+    /// for its fitting mode
+    static uint64_t key(const FitRequest& _request);
+
+    /// cached result for _key (empty if there is none), marks it as used
+    std::shared_ptr<const FitResult> find(uint64_t _key);
+
+    /// store _result for _key, evicting the least recently used entry
+    void insert(uint64_t _key, const std::shared_ptr<const FitResult>& _result);
+
+    /// remove all entries
+    void clear();
+
+    /// number of entries
+    size_t size() const { return entries_.size(); }
+
+    /// number of lookups that were answered / missed
+    unsigned long hits() const { return hits_; }
+    unsigned long misses() const { return misses_; }
+
+private:
+
+    typedef std::pair<uint64_t, std::shared_ptr<const FitResult> > Entry;
+
+    size_t capacity_;
+
+    /// entries, most recently used first
+    std::list<Entry> entries_;
+
+    /// position of each key in entries_
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+
+    /// statistics
+    unsigned long hits_, misses_;
+};
+
+//=============================================================================
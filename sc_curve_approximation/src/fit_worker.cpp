@@ -0,0 +1,124 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "fit_worker.h"
+
+//== IMPLEMENTATION ===========================================================
+
+FitWorker::FitWorker()
+    : mailbox_(nullptr),
+      stop_(false),
+      busy_(false),
+      cancels_(0),
+      request_cancels_(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+FitWorker::~FitWorker()
+{
+  stop();
+}
+
+//-----------------------------------------------------------------------------
+
+void FitWorker::start(const Fit_function& _fit)
+{
+  assert(!thread_.joinable());
+
+  fit_  = _fit;
+  stop_ = false;
+  thread_ = std::thread(&FitWorker::run, this);
+}
+
+//-----------------------------------------------------------------------------
+
+void FitWorker::stop()
+{
+  if (!thread_.joinable()) return;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wakeup_.notify_one();
+  thread_.join();
+
+  delete mailbox_.exchange(nullptr);
+}
+
+//-----------------------------------------------------------------------------
+
+void FitWorker::post(FitRequest* _request)
+{
+  // replace the pending request, which is stale now
+  delete mailbox_.exchange(_request);
+
+  // the lock only makes sure the worker does not miss the wake-up call
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+  }
+  wakeup_.notify_one();
+}
+
+//-----------------------------------------------------------------------------
+
+void FitWorker::cancel()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++cancels_;
+  delete mailbox_.exchange(nullptr);
+}
+
+//-----------------------------------------------------------------------------
+
+void FitWorker::run()
+{
+  for (;;)
+  {
+    // sleep until there is something to do
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wakeup_.wait(lock,
+                   [this]() { return stop_ || mailbox_.load() != nullptr; });
+    }
+    if (stop_) return;
+
+    // take the latest request out of the mailbox, together with the
+    // cancel count it has to be compared against
+    busy_ = true;
+    std::unique_ptr<FitRequest> request;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      request.reset(mailbox_.exchange(nullptr));
+      request_cancels_ = cancels_.load();
+    }
+    if (!request)
+    {
+      busy_ = false;
+      continue;
+    }
+
+    // fit and publish the result, unless newer input arrived meanwhile
+    std::shared_ptr<FitResult> result = std::make_shared<FitResult>();
+    result->generation = request->generation;
+    result->key        = request->key;
+    result->degree     = -1;
+    result->condition  = 0.0;
+    result->solve_time = 0.0;
+    if (fit_(*request, *result) && cancels_ == request_cancels_)
+      std::atomic_store(&result_, std::shared_ptr<const FitResult>(result));
+
+    busy_ = false;
+  }
+}
+
+//=============================================================================
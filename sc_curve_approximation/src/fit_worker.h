@@ -0,0 +1,165 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "types.h"
+#include "dataset.h"
+
+//== CLASS DEFINITION =========================================================
+
+/// snapshot of everything needed to fit a curve
+struct FitRequest
+{
+    /// increasing id of the request
+    unsigned long generation;
+
+    /// x- and y-coordinates of the constraints
+    std::vector<Scalar> x, y;
+
+    /// memory-mapped constraints, used instead of x and y if set
+    std::shared_ptr<const Dataset> dataset;
+
+    /// fingerprint of the constraints (see ConstraintFingerprint)
+    uint64_t fingerprint;
+
+    /// key of the request in the fit cache
+    uint64_t key;
+
+    /// interpolate (0) or approximate (1)
+    int fitting;
+
+    /// solver for interpolation and approximation, respectively
+    int interpolation_solver, approximation_solver;
+
+    /// polynomial degree for approximation
+    int degree;
+
+    /// select the degree by cross-validation, using which criterion?
+    bool auto_degree;
+    int  degree_criterion;
+};
+
+/// result of a fit
+struct FitResult
+{
+    /// generation of the request this is the answer to
+    unsigned long generation;
+
+    /// cache key of that request
+    uint64_t key;
+
+    /// coefficients of the polynomial
+    std::vector<Scalar> coefficients;
+
+    /// degree chosen by cross-validation (-1 if not selected automatically)
+    int degree;
+
+    /// log10 of the cross-validation score of each tested degree
+    std::vector<float> cv_scores;
+
+    /// solvers tried by the automatic policy (empty for a fixed solver)
+    std::string solver;
+
+    /// condition estimate of the accepted solve (0 if not estimated)
+    Scalar condition;
+
+    /// time spent solving the system [ms]
+    double solve_time;
+};
+
+//-----------------------------------------------------------------------------
+
+/// Background thread that fits curves.
+///
+/// Requests are posted into a single-slot mailbox: a newer request replaces
+/// a pending one, so stale requests are dropped instead of queued. While a
+/// fit is running, cancelled() tells it that newer input has arrived. The
+/// latest result is published atomically and can be read from any thread.
+class FitWorker
+{
+public:
+
+    /// the fit function; returns false if it was cancelled
+    typedef std::function<bool(const FitRequest&, FitResult&)> Fit_function;
+
+    /// constructor
+    FitWorker();
+
+    /// destructor, stops the thread
+    ~FitWorker();
+
+    /// start the worker thread
+    void start(const Fit_function& _fit);
+
+    /// stop the worker thread, pending requests are dropped
+    void stop();
+
+    /// post a request (takes ownership), replacing a pending one
+    void post(FitRequest* _request);
+
+    /// drop the pending request and cancel the running one
+    void cancel();
+
+    /// should the running fit be abandoned?
+    bool cancelled() const
+    {
+        return mailbox_.load() != nullptr ||
+               cancels_.load() != request_cancels_.load() || stop_.load();
+    }
+
+    /// is a fit running or pending?
+    bool busy() const { return busy_.load() || mailbox_.load() != nullptr; }
+
+    /// latest published result (may be empty)
+    std::shared_ptr<const FitResult> result() const
+    {
+        return std::atomic_load(&result_);
+    }
+
+private:
+
+    /// main loop of the worker thread
+    void run();
+
+private:
+
+    Fit_function fit_;
+    std::thread  thread_;
+
+    /// single-slot mailbox
+    std::atomic<FitRequest*> mailbox_;
+
+    /// state flags
+    std::atomic<bool> stop_, busy_;
+
+    /// number of cancel() calls, and its value when the running request
+    /// was taken out of the mailbox. Both change under mutex_, so a cancel()
+    /// either drops the request or cancels its fit.
+    std::atomic<unsigned long> cancels_, request_cancels_;
+
+    /// used to sleep while the mailbox is empty, and to take a request
+    std::mutex              mutex_;
+    std::condition_variable wakeup_;
+
+    /// latest result, accessed with std::atomic_load/store
+    std::shared_ptr<const FitResult> result_;
+};
+
+//=============================================================================
@@ -12,22 +12,26 @@
 
 //== CLASS DEFINITION =========================================================
 
-bool LU_Solver::factorize(const MatrixXX& A)
+bool LU_Solver::factorize(const Eigen::Ref<const MatrixXX>& A)
 {
   assert(A.rows() == A.cols());
 
   int i, j, k;
   const int m = A.rows();
 
-  // initialize L, U
-  L.resize(m, m);
-  L = MatrixXX::Identity(m, m);
-  U.resize(m, m);
-  U = A;
+  // initialize L, U (grow-only, work on the leading m x m blocks)
+  n_ = m;
+  Workspace::reserve(L, m, m);
+  Workspace::reserve(U, m, m);
+  L.topLeftCorner(m, m).setIdentity();
+  U.topLeftCorner(m, m) = A;
 
   // main loop --> subtraction row
   for (k = 0; k < m; ++k)
   {
+    // stop early if the result is not needed anymore
+    if (cancel && cancel()) return false;
+
     // if the next diagonal element is too small, the matrix is singular
     if (fabs(U(k, k)) < 5 * std::numeric_limits<Scalar>::min())
     {
@@ -55,13 +59,17 @@ bool LU_Solver::factorize(const MatrixXX& A)
   }
 
   // check error of LU factorization
-  std::cout << "  error(A = L*U) : " << (A - L * U).norm() << std::endl;
+  if (verbose)
+    std::cout << "  error(A = L*U) : "
+              << (A - L.topLeftCorner(m, m) * U.topLeftCorner(m, m)).norm()
+              << std::endl;
   return true;
 }
 
 //-----------------------------------------------------------------------------
 
-void LU_Solver::solve(const VectorX& _b, VectorX& _x)
+void LU_Solver::solve(const Eigen::Ref<const VectorX>& _b,
+                      Eigen::Ref<VectorX> _x)
 {
   /**
    * Solve the system `A * _x = b`, using the computed factorization of
@@ -72,8 +80,9 @@ void LU_Solver::solve(const VectorX& _b, VectorX& _x)
    */
 
   int i, j;
-  const int m = L.rows();
-  VectorX _y(m);
+  const int m = n_;
+  Workspace::reserve(y_, m);
+  Eigen::VectorBlock<VectorX> _y = y_.head(m);
   double sum = 0.0;
 
   // 1) Solve `L * y = b`
@@ -89,7 +98,9 @@ void LU_Solver::solve(const VectorX& _b, VectorX& _x)
   }
 
   // std::cout << "  y: \n" << _y << std::endl;
-  std::cout << "  error(L * y = b) : " << (L * _y - _b).norm() << std::endl;
+  if (verbose)
+    std::cout << "  error(L * y = b) : "
+              << (L.topLeftCorner(m, m) * _y - _b).norm() << std::endl;
 
   // 2) Solve `U * x = y`
   for (i = m-1; i >= 0; i--)
@@ -103,7 +114,9 @@ void LU_Solver::solve(const VectorX& _b, VectorX& _x)
   }
 
   // std::cout << "  x: \n" << _x << std::endl;
-  std::cout << "  error(U * x = y) : " << (U * _x - _y).norm() << std::endl;
+  if (verbose)
+    std::cout << "  error(U * x = y) : "
+              << (U.topLeftCorner(m, m) * _x - _y).norm() << std::endl;
 }
 
 //=============================================================================
@@ -11,8 +11,10 @@
 //=============================================================================
 
 #include <iostream>
+#include <functional>
 #include <Eigen/Dense>
 #include "types.h"
+#include "workspace.h"
 
 //== CLASS DEFINITION =========================================================
 
@@ -22,18 +24,38 @@ class LU_Solver
 public:
 
     /// empty constructor
-    LU_Solver() {}
+    LU_Solver() : verbose(true), n_(0) {}
 
     /// factorize matrix A=L*U
-    virtual bool factorize(const MatrixXX& _A);
+    virtual bool factorize(const Eigen::Ref<const MatrixXX>& _A);
 
     /// solve A*x=b
-    virtual void solve(const VectorX& _b, VectorX& _x);
+    virtual void solve(const Eigen::Ref<const VectorX>& _b, Eigen::Ref<VectorX> _x);
+
+    /// dimension of the current factorization
+    int size() const { return n_; }
 
 public:
 
-    /// store factors A=L*U
+    /// store factors A=L*U. The buffers only grow (see Workspace), the
+    /// factors are their leading size() x size() blocks.
     MatrixXX L, U;
+
+    /// print the errors of factorization and solve? Checking them costs an
+    /// extra matrix product and temporary allocations.
+    bool verbose;
+
+    /// if set, factorize() is abandoned (returns false) as soon as this
+    /// returns true. It is checked once per elimination step.
+    std::function<bool()> cancel;
+
+protected:
+
+    /// dimension of the current factorization
+    int n_;
+
+    /// intermediate solution L*y=b
+    VectorX y_;
 };
 
 //=============================================================================
@@ -0,0 +1,430 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "out_of_core_lu.h"
+#include "thread_pool.h"
+
+#include <pmp/Timer.h>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <memory>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//== IMPLEMENTATION ===========================================================
+
+static_assert(sizeof(OutOfCoreLU_Solver::Header) == 64,
+              "tile file header has to be 64 bytes");
+
+namespace {
+
+const char MAGIC[8] = "SCTILES";
+
+} // anonymous namespace
+
+//-----------------------------------------------------------------------------
+
+OutOfCoreLU_Solver::OutOfCoreLU_Solver()
+    : verbose(true), data_(nullptr), bytes_(0)
+{
+#ifdef _WIN32
+  file_ = mapping_ = nullptr;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+OutOfCoreLU_Solver::~OutOfCoreLU_Solver()
+{
+  close();
+}
+
+//-----------------------------------------------------------------------------
+
+bool OutOfCoreLU_Solver::map(const std::string& _filename, size_t _bytes,
+                             bool _create)
+{
+#ifdef _WIN32
+  HANDLE file = CreateFileA(_filename.c_str(), GENERIC_READ | GENERIC_WRITE,
+                            0, nullptr, _create ? CREATE_ALWAYS : OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    std::cerr << "OutOfCoreLU_Solver: cannot open " << _filename << std::endl;
+    return false;
+  }
+  if (!_create)
+  {
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    _bytes = size.QuadPart;
+  }
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE,
+                                      DWORD(uint64_t(_bytes) >> 32),
+                                      DWORD(_bytes & 0xffffffff), nullptr);
+  void* data =
+      mapping ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0) : nullptr;
+  if (!data)
+  {
+    std::cerr << "OutOfCoreLU_Solver: cannot map " << _filename << std::endl;
+    if (mapping) CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+  file_    = file;
+  mapping_ = mapping;
+#else
+  int fd = ::open(_filename.c_str(), _create ? O_RDWR | O_CREAT | O_TRUNC
+                                             : O_RDWR,
+                  0644);
+  if (fd < 0)
+  {
+    std::cerr << "OutOfCoreLU_Solver: cannot open " << _filename << std::endl;
+    return false;
+  }
+  if (_create)
+  {
+    // sparse file, tiles read as zero until they are written
+    if (ftruncate(fd, _bytes) != 0)
+    {
+      std::cerr << "OutOfCoreLU_Solver: cannot resize " << _filename
+                << std::endl;
+      ::close(fd);
+      return false;
+    }
+  }
+  else
+  {
+    struct stat st;
+    fstat(fd, &st);
+    _bytes = st.st_size;
+  }
+  void* data = _bytes > 0 ? mmap(nullptr, _bytes, PROT_READ | PROT_WRITE,
+                                 MAP_SHARED, fd, 0)
+                          : MAP_FAILED;
+  ::close(fd);  // the mapping stays valid
+  if (data == MAP_FAILED)
+  {
+    std::cerr << "OutOfCoreLU_Solver: cannot map " << _filename << std::endl;
+    return false;
+  }
+#endif
+
+  data_  = static_cast<char*>(data);
+  bytes_ = _bytes;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool OutOfCoreLU_Solver::create(const std::string& _filename, int _n,
+                                int _tile_size)
+{
+  assert(_n > 0 && _tile_size > 0);
+
+  close();
+
+  const size_t nt    = (_n + _tile_size - 1) / _tile_size;
+  const size_t bytes = DATA_OFFSET + nt * nt * _tile_size * _tile_size *
+                       sizeof(Scalar);
+  if (!map(_filename, bytes, true)) return false;
+
+  Header& h = header();
+  memset(&h, 0, sizeof(Header));
+  memcpy(h.magic, MAGIC, 8);
+  h.version      = VERSION;
+  h.scalar_bytes = sizeof(Scalar);
+  h.size         = _n;
+  h.tile_size    = _tile_size;
+  h.factorized   = 0;
+
+  // the file is all zeros: set the diagonal to get the identity
+  for (int i = 0; i < n_tiles(); ++i) tile(i, i).setIdentity();
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool OutOfCoreLU_Solver::open(const std::string& _filename)
+{
+  close();
+
+  if (!map(_filename, 0, false)) return false;
+
+  // check header and file size
+  const Header& h = header();
+  if (bytes_ < DATA_OFFSET || memcmp(h.magic, MAGIC, 8) != 0 ||
+      h.version != VERSION || h.tile_size == 0)
+  {
+    std::cerr << "OutOfCoreLU_Solver: " << _filename
+              << " is not a tile file\n";
+    close();
+    return false;
+  }
+  if (h.scalar_bytes != sizeof(Scalar))
+  {
+    std::cerr << "OutOfCoreLU_Solver: " << _filename
+              << " was written with a different Scalar type\n";
+    close();
+    return false;
+  }
+  if (bytes_ < DATA_OFFSET + size_t(n_tiles()) * n_tiles() * tile_bytes())
+  {
+    std::cerr << "OutOfCoreLU_Solver: " << _filename << " is truncated\n";
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void OutOfCoreLU_Solver::close()
+{
+  if (!data_) return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(data_);
+  CloseHandle((HANDLE)mapping_);
+  CloseHandle((HANDLE)file_);
+  file_ = mapping_ = nullptr;
+#else
+  munmap(data_, bytes_);
+#endif
+
+  data_  = nullptr;
+  bytes_ = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+Eigen::Map<MatrixXX> OutOfCoreLU_Solver::tile(int _I, int _J) const
+{
+  const size_t index = size_t(_J) * n_tiles() + _I;
+  return Eigen::Map<MatrixXX>(
+      reinterpret_cast<Scalar*>(data_ + DATA_OFFSET + index * tile_bytes()),
+      tile_size(), tile_size());
+}
+
+//-----------------------------------------------------------------------------
+
+void OutOfCoreLU_Solver::pad()
+{
+  const int n = size(), b = tile_size(), nt = n_tiles();
+  const int k = nt * b - n;  // padded rows/columns
+  if (k == 0) return;
+
+  for (int I = 0; I < nt; ++I)
+  {
+    tile(I, nt - 1).rightCols(k).setZero();
+    tile(nt - 1, I).bottomRows(k).setZero();
+  }
+  tile(nt - 1, nt - 1).bottomRightCorner(k, k).setIdentity();
+}
+
+//-----------------------------------------------------------------------------
+
+void OutOfCoreLU_Solver::fill(const Tile_function& _fill)
+{
+  const int n = size(), b = tile_size(), nt = n_tiles();
+
+  // tile column by tile column, i.e. sequentially through the file
+  for (int J = 0; J < nt; ++J)
+  {
+    for (int I = 0; I < nt; ++I)
+    {
+      const int rows = std::min(b, n - I * b), cols = std::min(b, n - J * b);
+      Eigen::Map<MatrixXX> T = tile(I, J);
+      _fill(I * b, J * b, T.topLeftCorner(rows, cols));
+    }
+  }
+
+  pad();
+  header().factorized = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void OutOfCoreLU_Solver::set(const Eigen::Ref<const MatrixXX>& _A)
+{
+  assert(_A.rows() == size() && _A.cols() == size());
+
+  fill([&_A](int _row, int _col, Eigen::Ref<MatrixXX> _tile) {
+    _tile = _A.block(_row, _col, _tile.rows(), _tile.cols());
+  });
+}
+
+//-----------------------------------------------------------------------------
+
+void OutOfCoreLU_Solver::prefetch(int _first, int _J) const
+{
+  if (_first >= n_tiles()) return;
+
+  // tiles _first..n_tiles()-1 of a tile column are contiguous in the file
+  const char* begin = reinterpret_cast<const char*>(tile(_first, _J).data());
+  const char* end   = begin + (n_tiles() - _first) * tile_bytes();
+
+#ifndef _WIN32
+  // start the read-ahead for the whole range at once
+  const uintptr_t page  = 4096;
+  char*           start = reinterpret_cast<char*>(
+      reinterpret_cast<uintptr_t>(begin) & ~(page - 1));
+  madvise(start, end - start, MADV_WILLNEED);
+#endif
+
+  // ... and wait until every page is resident
+  volatile char sink = 0;
+  for (const char* p = begin; p < end; p += 4096) sink = sink + *p;
+}
+
+//-----------------------------------------------------------------------------
+
+bool OutOfCoreLU_Solver::factorize()
+{
+  /**
+   * Right-looking block LU without pivoting. For each tile column K:
+   * 1. factorize the diagonal tile A_KK = L_KK * U_KK in place,
+   * 2. panel: A_IK = A_IK * U_KK^-1 for I > K,
+   * 3. for each tile column J > K: A_KJ = L_KK^-1 * A_KJ, then update the
+   *    trailing tiles A_IJ -= A_IK * A_KJ for I > K.
+   * Step 3 reads every tile column once, while the next one is prefetched.
+   */
+
+  assert(is_open());
+
+  const int nt = n_tiles(), b = tile_size();
+  int       i, I, J, K;
+
+  pmp::Timer timer;
+  timer.start();
+
+  // one thread reads ahead for the whole factorization
+  ThreadPool prefetcher(1);
+  prefetch(0, 0);
+
+  for (K = 0; K < nt; ++K)
+  {
+    // stop early if the result is not needed anymore
+    if (cancel && cancel()) return false;
+
+    // 1. unblocked LU of the diagonal tile
+    Eigen::Map<MatrixXX> D = tile(K, K);
+    for (i = 0; i < b; ++i)
+    {
+      // if the next diagonal element is too small, the matrix is singular
+      if (fabs(D(i, i)) < 5 * std::numeric_limits<Scalar>::min())
+      {
+        std::cerr << "OutOfCoreLU_Solver: Factorization failed." << std::endl;
+        return false;
+      }
+
+      const int r = b - i - 1;
+      D.col(i).tail(r) /= D(i, i);
+      D.bottomRightCorner(r, r).noalias() -=
+          D.col(i).tail(r) * D.row(i).tail(r);
+    }
+
+    // 2. panel below the diagonal tile
+    for (I = K + 1; I < nt; ++I)
+    {
+      Eigen::Map<MatrixXX> P = tile(I, K);
+      D.triangularView<Eigen::Upper>().solveInPlace<Eigen::OnTheRight>(P);
+    }
+
+    // 3. trailing matrix, one tile column at a time
+    for (J = K + 1; J < nt; ++J)
+    {
+      // read the next tile column while this one is updated. Its top tile
+      // is the diagonal tile of the next step, if J is the last column.
+      const int next_column = (J + 1 < nt ? J + 1 : K + 1);
+      std::shared_ptr<std::promise<void>> read(new std::promise<void>);
+      std::future<void> next = read->get_future();
+      prefetcher.submit([this, K, next_column, read]() {
+        prefetch(K + 1, next_column);
+        read->set_value();
+      });
+
+      Eigen::Map<MatrixXX> R = tile(K, J);
+      D.triangularView<Eigen::UnitLower>().solveInPlace(R);
+
+      for (I = K + 1; I < nt; ++I)
+      {
+        Eigen::Map<MatrixXX> T = tile(I, J);
+        T.noalias() -= tile(I, K) * R;
+      }
+
+      next.wait();
+    }
+  }
+
+  header().factorized = 1;
+
+  timer.stop();
+  if (verbose)
+  {
+    const double n = size();
+    std::cout << "OutOfCoreLU_Solver: factorized " << size() << "x" << size()
+              << " in " << nt << "x" << nt << " tiles, " << timer << " ("
+              << 2.0 / 3.0 * n * n * n / timer.elapsed() * 1e-6
+              << " GFLOP/s)" << std::endl;
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void OutOfCoreLU_Solver::solve(const Eigen::Ref<const VectorX>& _b,
+                               Eigen::Ref<VectorX> _x)
+{
+  assert(is_factorized());
+  assert(_b.rows() == size() && _x.rows() == size());
+
+  const int n = size(), b = tile_size(), nt = n_tiles();
+  int       I, J;
+
+  // padded right hand side
+  y_.resize(nt * b);
+  y_.head(n) = _b;
+  y_.tail(nt * b - n).setZero();
+
+  // 1) Solve `L * y = b`, column-oriented to stream through the file
+  for (J = 0; J < nt; ++J)
+  {
+    Eigen::Map<MatrixXX> D = tile(J, J);
+    D.triangularView<Eigen::UnitLower>().solveInPlace(y_.segment(J * b, b));
+    for (I = J + 1; I < nt; ++I)
+      y_.segment(I * b, b).noalias() -= tile(I, J) * y_.segment(J * b, b);
+  }
+
+  // 2) Solve `U * x = y`
+  for (J = nt - 1; J >= 0; --J)
+  {
+    Eigen::Map<MatrixXX> D = tile(J, J);
+    D.triangularView<Eigen::Upper>().solveInPlace(y_.segment(J * b, b));
+    for (I = 0; I < J; ++I)
+      y_.segment(I * b, b).noalias() -= tile(I, J) * y_.segment(J * b, b);
+  }
+
+  _x = y_.head(n);
+}
+
+//=============================================================================
@@ -0,0 +1,151 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <Eigen/Dense>
+#include "types.h"
+
+//== CLASS DEFINITION =========================================================
+
+/// LU solver for matrices that do not fit into memory.
+///
+/// The matrix is stored as square tiles in a memory-mapped file, tile
+/// column after tile column, each tile in column-major order. The last tile
+/// row and column are padded with the identity, so every tile has the same
+/// size. factorize() overwrites the tiles with L (unit diagonal omitted) and
+/// U. Like LU_Solver it does not pivot, so the matrix should be diagonally
+/// dominant or symmetric positive definite.
+///
+/// The factorization is a right-looking block LU that streams over the
+/// trailing matrix one tile column at a time. Only the current panel and
+/// two tile columns have to be resident, and the next tile column is read
+/// in on a second thread while the current one is updated. The operating
+/// system writes modified tiles back and evicts them as needed.
+class OutOfCoreLU_Solver
+{
+public:
+
+    /// fills the _rows x _cols tile whose top left entry is A(_row, _col)
+    typedef std::function<void(int _row, int _col, Eigen::Ref<MatrixXX> _tile)>
+        Tile_function;
+
+    /// file header
+    struct Header
+    {
+        char     magic[8];     ///< "SCTILES" plus terminating zero
+        uint32_t version;      ///< format version
+        uint32_t scalar_bytes; ///< sizeof(Scalar) the file was written with
+        uint64_t size;         ///< dimension n of the matrix
+        uint64_t tile_size;    ///< dimension of a tile
+        uint64_t factorized;   ///< does the file hold L and U?
+        uint8_t  reserved[24];
+    };
+
+    /// file format version
+    static const uint32_t VERSION = 1;
+
+    /// offset of the first tile, a page boundary
+    static const size_t DATA_OFFSET = 4096;
+
+    /// constructor
+    OutOfCoreLU_Solver();
+
+    /// destructor, unmaps the file
+    ~OutOfCoreLU_Solver();
+
+    /// create (or overwrite) the file _filename for a _n x _n matrix, stored
+    /// in tiles of _tile_size x _tile_size. The matrix is initialized to the
+    /// identity.
+    bool create(const std::string& _filename, int _n, int _tile_size = 512);
+
+    /// map an existing file
+    bool open(const std::string& _filename);
+
+    /// unmap the file
+    void close();
+
+    /// is a file mapped?
+    bool is_open() const { return data_ != nullptr; }
+
+    /// dimension of the matrix
+    int size() const { return header().size; }
+
+    /// dimension of a tile
+    int tile_size() const { return header().tile_size; }
+
+    /// number of tile rows (and columns)
+    int n_tiles() const { return (size() + tile_size() - 1) / tile_size(); }
+
+    /// does the file hold the factors?
+    bool is_factorized() const { return header().factorized != 0; }
+
+    /// fill the matrix tile by tile
+    void fill(const Tile_function& _fill);
+
+    /// copy an in-core matrix into the file (for testing)
+    void set(const Eigen::Ref<const MatrixXX>& _A);
+
+    /// factorize the matrix in the file, A=L*U
+    bool factorize();
+
+    /// solve A*x=b, streaming once over the factors for each triangle
+    void solve(const Eigen::Ref<const VectorX>& _b, Eigen::Ref<VectorX> _x);
+
+public:
+
+    /// print progress and throughput of the factorization?
+    bool verbose;
+
+    /// if set, factorize() is abandoned (returns false) as soon as this
+    /// returns true. It is checked once per tile column.
+    std::function<bool()> cancel;
+
+private:
+
+    Header& header() const { return *reinterpret_cast<Header*>(data_); }
+
+    /// tile (_I, _J), i.e. rows _I*tile_size()... and columns _J*tile_size()...
+    Eigen::Map<MatrixXX> tile(int _I, int _J) const;
+
+    /// bytes of one tile
+    size_t tile_bytes() const
+    {
+        return size_t(tile_size()) * tile_size() * sizeof(Scalar);
+    }
+
+    /// read tiles _first..n_tiles()-1 of tile column _J into memory
+    void prefetch(int _first, int _J) const;
+
+    /// set the padding of the last tile row and column to the identity
+    void pad();
+
+    /// map _filename, which is created with _bytes bytes if _create is set
+    bool map(const std::string& _filename, size_t _bytes, bool _create);
+
+private:
+
+    /// mapped file
+    char*  data_;
+    size_t bytes_;
+
+    /// padded right hand side and solution
+    VectorX y_;
+
+#ifdef _WIN32
+    void* file_;
+    void* mapping_;
+#endif
+};
+
+//=============================================================================
@@ -0,0 +1,253 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "solver_shootout.h"
+#include "lu.h"
+#include "cholesky.h"
+#include <pmp/Timer.h>
+#include <Eigen/Dense>
+
+//== IMPLEMENTATION ===========================================================
+
+namespace {
+
+/// time one of Eigen's decompositions
+template <class Decomposition>
+void time_eigen(const MatrixXX& _M, const VectorX& _rhs, VectorX& _x,
+                double& _factorize_time, double& _solve_time)
+{
+  Decomposition decomposition;
+  pmp::Timer    timer;
+
+  timer.start();
+  decomposition.compute(_M);
+  timer.stop();
+  _factorize_time = timer.elapsed();
+
+  timer.start();
+  _x = decomposition.solve(_rhs);
+  timer.stop();
+  _solve_time = timer.elapsed();
+}
+
+//-----------------------------------------------------------------------------
+
+/// time one of our solvers
+template <class Solver>
+bool time_ours(const MatrixXX& _M, const VectorX& _rhs, VectorX& _x,
+               double& _factorize_time, double& _solve_time)
+{
+  Solver     solver;
+  pmp::Timer timer;
+  solver.verbose = false;
+
+  timer.start();
+  const bool ok = solver.factorize(_M);
+  timer.stop();
+  _factorize_time = timer.elapsed();
+  if (!ok) return false;
+
+  timer.start();
+  solver.solve(_rhs, _x);
+  timer.stop();
+  _solve_time = timer.elapsed();
+  return true;
+}
+
+} // anonymous namespace
+
+//-----------------------------------------------------------------------------
+
+SolverShootout::SolverShootout() : timings_(N_SOLVERS), running_(0)
+{
+  const char* names[N_SOLVERS] = {"Eigen's LU", "Our LU", "Eigen's Cholesky",
+                                  "Our Cholesky", "Eigen's QR"};
+  for (int i = 0; i < N_SOLVERS; ++i)
+  {
+    timings_[i].name           = names[i];
+    timings_[i].applicable     = false;
+    timings_[i].factorize_time = timings_[i].solve_time = 0.0;
+    timings_[i].residual       = 0.0;
+    timings_[i].gflops         = 0.0;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+bool SolverShootout::run(const FitRequest& _request)
+{
+  if (busy()) return false;
+
+  running_ = 1;
+  FitRequest request = _request;
+  pool_.submit([this, request]() { setup(request); });
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<SolverTiming> SolverShootout::timings() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return timings_;
+}
+
+//-----------------------------------------------------------------------------
+
+void SolverShootout::setup(const FitRequest& _request)
+{
+  const bool interpolate = (_request.fitting == 0);
+  int        i, j;
+
+  if (interpolate && !_request.dataset)
+  {
+    // square Vandermonde system
+    const int m = _request.x.size();
+    system_.resize(m, m);
+    rhs_.resize(m);
+    for (i = 0; i < m; ++i)
+    {
+      rhs_(i) = _request.y[i];
+      for (j = 0; j < m; ++j) system_(i, j) = pow(_request.x[i], j);
+    }
+  }
+  else if (!interpolate)
+  {
+    // normal equations
+    const int n = _request.degree + 1;
+    system_.resize(n, n);
+    rhs_.resize(n);
+    if (_request.dataset)
+    {
+      _request.dataset->normal_equations(_request.degree, system_, rhs_);
+    }
+    else
+    {
+      const int m = _request.x.size();
+      MatrixXX  A(m, n);
+      VectorX   b(m);
+      for (i = 0; i < m; ++i)
+      {
+        b(i) = _request.y[i];
+        for (j = 0; j < n; ++j) A(i, j) = pow(_request.x[i], j);
+      }
+      system_.noalias() = A.transpose() * A;
+      rhs_.noalias()    = A.transpose() * b;
+    }
+  }
+  else
+  {
+    // datasets are not interpolated
+    system_.resize(0, 0);
+    rhs_.resize(0);
+  }
+
+  // Cholesky needs a symmetric positive definite matrix
+  bool applicable[N_SOLVERS];
+  for (i = 0; i < N_SOLVERS; ++i)
+    applicable[i] = system_.rows() > 0 &&
+                    (!interpolate || (i != CHOLESKY_EIGEN && i != CHOLESKY));
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (i = 0; i < N_SOLVERS; ++i) timings_[i].applicable = applicable[i];
+  }
+
+  // start all solvers, this task counts as running until they are queued
+  for (i = 0; i < N_SOLVERS; ++i)
+  {
+    if (!applicable[i]) continue;
+    ++running_;
+    const Solver_id id = (Solver_id)i;
+    pool_.submit([this, id]() {
+      measure(id);
+      --running_;
+    });
+  }
+  --running_;
+}
+
+//-----------------------------------------------------------------------------
+
+void SolverShootout::measure(Solver_id _id)
+{
+  VectorX x(system_.rows());
+  double  factorize_time = 0.0, solve_time = 0.0;
+  bool    ok             = true;
+
+  switch (_id)
+  {
+    case LU_EIGEN:
+      time_eigen<Eigen::FullPivLU<MatrixXX> >(system_, rhs_, x,
+                                              factorize_time, solve_time);
+      break;
+    case LU:
+      ok = time_ours<LU_Solver>(system_, rhs_, x, factorize_time, solve_time);
+      break;
+    case CHOLESKY_EIGEN:
+      time_eigen<Eigen::LDLT<MatrixXX> >(system_, rhs_, x, factorize_time,
+                                         solve_time);
+      break;
+    case CHOLESKY:
+      ok = time_ours<CholeskySolver>(system_, rhs_, x, factorize_time,
+                                     solve_time);
+      break;
+    case QR_EIGEN:
+      time_eigen<Eigen::FullPivHouseholderQR<MatrixXX> >(
+          system_, rhs_, x, factorize_time, solve_time);
+      break;
+    default:
+      return;
+  }
+
+  // a failed factorization has no meaningful solution
+  if (!ok) x.setConstant(std::numeric_limits<Scalar>::quiet_NaN());
+
+  report(_id, factorize_time, solve_time, x);
+}
+
+//-----------------------------------------------------------------------------
+
+void SolverShootout::report(Solver_id _id, double _factorize_time,
+                            double _solve_time,
+                            const Eigen::Ref<const VectorX>& _x)
+{
+  // flops of the factorizations of an n x n matrix
+  const double n = system_.rows();
+  double       flops;
+  switch (_id)
+  {
+    case CHOLESKY_EIGEN:
+    case CHOLESKY:
+      flops = n * n * n / 3.0;
+      break;
+    case QR_EIGEN:
+      flops = 4.0 / 3.0 * n * n * n;
+      break;
+    default:
+      flops = 2.0 / 3.0 * n * n * n;
+      break;
+  }
+
+  const Scalar residual = (system_ * _x - rhs_).norm();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  SolverTiming& timing  = timings_[_id];
+  timing.factorize_time = _factorize_time;
+  timing.solve_time     = _solve_time;
+  timing.residual       = residual;
+  timing.gflops =
+      _factorize_time > 0.0 ? flops / _factorize_time * 1e-6 : 0.0;
+  timing.history.push_back(_factorize_time + _solve_time);
+  if (timing.history.size() > HISTORY_SIZE)
+    timing.history.erase(timing.history.begin());
+}
+
+//=============================================================================
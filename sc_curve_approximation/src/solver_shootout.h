@@ -0,0 +1,115 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "types.h"
+#include "fit_worker.h"
+#include "thread_pool.h"
+
+//== CLASS DEFINITION =========================================================
+
+/// timings of one solver in the shoot-out
+struct SolverTiming
+{
+    /// name shown in the GUI
+    std::string name;
+
+    /// did the solver take part in the last run?
+    bool applicable;
+
+    /// wall-time of factorization and solve [ms]
+    double factorize_time, solve_time;
+
+    /// residual norm |M*x - rhs|
+    Scalar residual;
+
+    /// factorization throughput, counting the flops of the textbook algorithm
+    double gflops;
+
+    /// total time [ms] of the most recent runs, oldest first
+    std::vector<float> history;
+};
+
+//-----------------------------------------------------------------------------
+
+/// Times all applicable solvers on the same system, concurrently.
+///
+/// Interpolation systems (square Vandermonde matrices) are solved by the LU
+/// and QR solvers, the normal equations of an approximation by all solvers.
+/// Each solver runs as a task on a thread pool, with its own solver object,
+/// so the timings of concurrent solvers include their competition for
+/// cores and memory bandwidth.
+class SolverShootout
+{
+public:
+
+    /// the contestants
+    enum Solver_id
+    {
+        LU_EIGEN=0,
+        LU=1,
+        CHOLESKY_EIGEN=2,
+        CHOLESKY=3,
+        QR_EIGEN=4,
+        N_SOLVERS
+    };
+
+    /// number of runs kept in the history
+    static const int HISTORY_SIZE = 100;
+
+    /// constructor
+    SolverShootout();
+
+    /// start timing all solvers on the system of _request. Returns false
+    /// (and does nothing) while the previous run is still busy.
+    bool run(const FitRequest& _request);
+
+    /// is a run in progress?
+    bool busy() const { return running_.load() > 0; }
+
+    /// copy of the latest timings
+    std::vector<SolverTiming> timings() const;
+
+private:
+
+    /// set up the system matrix and right hand side, then start the solvers
+    void setup(const FitRequest& _request);
+
+    /// time solver _id on system_ and rhs_
+    void measure(Solver_id _id);
+
+    /// store the timings of solver _id
+    void report(Solver_id _id, double _factorize_time, double _solve_time,
+                const Eigen::Ref<const VectorX>& _x);
+
+private:
+
+    /// system of the current run, read-only while the solvers run
+    MatrixXX system_;
+    VectorX  rhs_;
+
+    /// timings, guarded by mutex_
+    mutable std::mutex        mutex_;
+    std::vector<SolverTiming> timings_;
+
+    /// number of unfinished tasks of the current run
+    std::atomic<int> running_;
+
+    /// declared last: destroyed (and joined) first, while the tasks can
+    /// still access the members above
+    ThreadPool pool_;
+};
+
+//=============================================================================
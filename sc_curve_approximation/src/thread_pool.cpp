@@ -0,0 +1,69 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "thread_pool.h"
+
+//== IMPLEMENTATION ===========================================================
+
+ThreadPool::ThreadPool(unsigned int _n_threads) : stop_(false)
+{
+  if (_n_threads == 0)
+    _n_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  for (unsigned int i = 0; i < _n_threads; ++i)
+    threads_.push_back(std::thread(&ThreadPool::run, this));
+}
+
+//-----------------------------------------------------------------------------
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wakeup_.notify_all();
+
+  for (std::thread& thread : threads_) thread.join();
+}
+
+//-----------------------------------------------------------------------------
+
+void ThreadPool::submit(const std::function<void()>& _task)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(_task);
+  }
+  wakeup_.notify_one();
+}
+
+//-----------------------------------------------------------------------------
+
+void ThreadPool::run()
+{
+  for (;;)
+  {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wakeup_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+
+      // only quit once the queue is drained
+      if (tasks_.empty()) return;
+
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+//=============================================================================
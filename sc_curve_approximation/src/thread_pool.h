@@ -0,0 +1,54 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//== CLASS DEFINITION =========================================================
+
+/// Fixed set of worker threads that run submitted tasks in FIFO order.
+/// Tasks may submit further tasks.
+class ThreadPool
+{
+public:
+
+    /// start _n_threads threads (0: one per hardware thread)
+    explicit ThreadPool(unsigned int _n_threads = 0);
+
+    /// destructor, finishes all queued tasks and joins the threads
+    ~ThreadPool();
+
+    /// queue _task for execution
+    void submit(const std::function<void()>& _task);
+
+    /// number of threads
+    unsigned int size() const { return threads_.size(); }
+
+private:
+
+    /// main loop of a worker thread
+    void run();
+
+private:
+
+    std::vector<std::thread>          threads_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex                        mutex_;
+    std::condition_variable           wakeup_;
+    bool                              stop_;
+};
+
+//=============================================================================
@@ -0,0 +1,69 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "workspace.h"
+
+//== IMPLEMENTATION ===========================================================
+
+std::atomic<unsigned long> Workspace::allocations_(0);
+
+//-----------------------------------------------------------------------------
+
+int Workspace::size_class(int _n)
+{
+  // smallest power of two >= _n, but at least 16
+  int c = 16;
+  while (c < _n) c *= 2;
+  return c;
+}
+
+//-----------------------------------------------------------------------------
+
+void Workspace::reserve(MatrixXX& _M, int _rows, int _cols)
+{
+  if (_M.rows() >= _rows && _M.cols() >= _cols) return;
+
+  // never shrink the other dimension
+  const int rows = size_class(std::max<int>(_rows, _M.rows()));
+  const int cols = size_class(std::max<int>(_cols, _M.cols()));
+  _M.resize(rows, cols);
+  ++allocations_;
+}
+
+//-----------------------------------------------------------------------------
+
+void Workspace::reserve(VectorX& _v, int _rows)
+{
+  if (_v.rows() >= _rows) return;
+
+  _v.resize(size_class(_rows));
+  ++allocations_;
+}
+
+//-----------------------------------------------------------------------------
+
+Workspace::MatrixBlock Workspace::matrix(Matrix_slot _slot, int _rows,
+                                         int _cols)
+{
+  assert(_slot < N_MATRIX_SLOTS);
+  reserve(matrices_[_slot], _rows, _cols);
+  return matrices_[_slot].topLeftCorner(_rows, _cols);
+}
+
+//-----------------------------------------------------------------------------
+
+Workspace::VectorBlock Workspace::vector(Vector_slot _slot, int _rows)
+{
+  assert(_slot < N_VECTOR_SLOTS);
+  reserve(vectors_[_slot], _rows);
+  return vectors_[_slot].head(_rows);
+}
+
+//=============================================================================
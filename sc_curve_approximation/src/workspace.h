@@ -0,0 +1,84 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <atomic>
+#include "types.h"
+
+//== CLASS DEFINITION =========================================================
+
+/// Grow-only buffer arena for the fitting pipeline.
+///
+/// Buffers are sized in power-of-two size classes and never shrink. Fitting
+/// a problem of the same or a smaller size as before therefore reuses the
+/// memory of earlier fits and does not touch the heap. The returned blocks
+/// are views into the leading part of a buffer.
+class Workspace
+{
+public:
+
+    typedef Eigen::Block<MatrixXX>      MatrixBlock; ///< view of a matrix slot
+    typedef Eigen::VectorBlock<VectorX> VectorBlock; ///< view of a vector slot
+
+    /// matrix buffers
+    enum Matrix_slot
+    {
+        SYSTEM=0,        ///< system matrix A
+        NORMAL_MATRIX=1, ///< normal equations A^T*A
+        N_MATRIX_SLOTS
+    };
+
+    /// vector buffers
+    enum Vector_slot
+    {
+        RHS=0,        ///< right hand side b
+        SOLUTION=1,   ///< solution x
+        NORMAL_RHS=2, ///< right hand side A^T*b of the normal equations
+        RESIDUAL=3,   ///< residual A*x-b
+        SCRATCH=4,    ///< temporary vector
+        ESTIMATE_X=5, ///< first vector of the condition estimator
+        ESTIMATE_Y=6, ///< second vector of the condition estimator
+        N_VECTOR_SLOTS
+    };
+
+    /// empty constructor
+    Workspace() {}
+
+    /// get a _rows x _cols view of matrix buffer _slot
+    MatrixBlock matrix(Matrix_slot _slot, int _rows, int _cols);
+
+    /// get a view of the first _rows entries of vector buffer _slot
+    VectorBlock vector(Vector_slot _slot, int _rows);
+
+    /// grow _M to hold at least _rows x _cols entries (contents are lost)
+    static void reserve(MatrixXX& _M, int _rows, int _cols);
+
+    /// grow _v to hold at least _rows entries (contents are lost)
+    static void reserve(VectorX& _v, int _rows);
+
+    /// number of heap allocations done by all workspace buffers so far
+    static unsigned long allocations() { return allocations_; }
+
+private:
+
+    /// round _n up to its size class
+    static int size_class(int _n);
+
+private:
+
+    MatrixXX matrices_[N_MATRIX_SLOTS];
+    VectorX  vectors_[N_VECTOR_SLOTS];
+
+    /// allocation counter
+    static std::atomic<unsigned long> allocations_;
+};
+
+//=============================================================================
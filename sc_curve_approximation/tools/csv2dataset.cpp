@@ -0,0 +1,95 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "dataset.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+//=============================================================================
+
+/// Convert a text file of "x,y" lines (comma, semicolon or whitespace
+/// separated) into a Dataset file. Lines that do not start with two numbers,
+/// e.g. a header, are skipped.
+int main(int argc, char** argv)
+{
+    Dataset::Type type       = Dataset::FLOAT64;
+    size_t        chunk_size = 1 << 16;
+    const char*   input      = nullptr;
+    const char*   output     = nullptr;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--float32"))
+            type = Dataset::FLOAT32;
+        else if (!strcmp(argv[i], "--chunk") && i + 1 < argc)
+            chunk_size = strtoul(argv[++i], nullptr, 10);
+        else if (!input)
+            input = argv[i];
+        else if (!output)
+            output = argv[i];
+    }
+
+    if (!input || !output || chunk_size == 0)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--float32] [--chunk <samples>] <input.csv> "
+                     "<output.scd>\n";
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream ifs(input);
+    if (!ifs)
+    {
+        std::cerr << "Cannot open " << input << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    DatasetWriter writer;
+    if (!writer.open(output, type, chunk_size)) return EXIT_FAILURE;
+
+    std::string line;
+    size_t      skipped = 0;
+    while (std::getline(ifs, line))
+    {
+        for (char& c : line)
+            if (c == ',' || c == ';') c = ' ';
+
+        std::istringstream iss(line);
+        Scalar             x, y;
+        if (!(iss >> x >> y))
+        {
+            ++skipped;
+            continue;
+        }
+
+        if (!writer.add(x, y))
+        {
+            std::cerr << "Cannot write " << output << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    const size_t count = writer.size();
+    if (!writer.close())
+    {
+        std::cerr << "Cannot write " << output << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Wrote " << count << " samples to " << output << " ("
+              << skipped << " lines skipped)\n";
+    return EXIT_SUCCESS;
+}
+
+//=============================================================================
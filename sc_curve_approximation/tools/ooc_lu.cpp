@@ -0,0 +1,112 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "out_of_core_lu.h"
+
+#include <pmp/Timer.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+//=============================================================================
+
+/// entry (_i, _j) of a reproducible, diagonally dominant test matrix
+Scalar entry(int _i, int _j, int _n)
+{
+    // splitmix64 hash of the position, mapped to [-1, 1]
+    uint64_t z = (uint64_t(_i) << 32 | uint32_t(_j)) + 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    z = z ^ (z >> 31);
+    const Scalar value = Scalar(z >> 11) / Scalar(1ull << 53) * 2.0 - 1.0;
+    return _i == _j ? value + _n : value;
+}
+
+//-----------------------------------------------------------------------------
+
+/// Factorize a generated n x n system out of core and check the solution.
+/// With --in-core the same system is also factorized in memory (Eigen's
+/// partial-pivoting LU) to compare the throughput.
+int main(int argc, char** argv)
+{
+    int         n         = 0;
+    int         tile_size = 512;
+    bool        in_core   = false;
+    const char* filename  = "ooc_lu.tiles";
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--tile") && i + 1 < argc)
+            tile_size = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--file") && i + 1 < argc)
+            filename = argv[++i];
+        else if (!strcmp(argv[i], "--in-core"))
+            in_core = true;
+        else
+            n = atoi(argv[i]);
+    }
+
+    if (n <= 0 || tile_size <= 0)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--tile <size>] [--file <tiles>] [--in-core] <n>\n";
+        return EXIT_FAILURE;
+    }
+
+    OutOfCoreLU_Solver solver;
+    if (!solver.create(filename, n, tile_size)) return EXIT_FAILURE;
+
+    pmp::Timer timer;
+    timer.start();
+    solver.fill([n](int _row, int _col, Eigen::Ref<MatrixXX> _tile) {
+        for (int j = 0; j < _tile.cols(); ++j)
+            for (int i = 0; i < _tile.rows(); ++i)
+                _tile(i, j) = entry(_row + i, _col + j, n);
+    });
+    timer.stop();
+    std::cout << "Filled " << filename << " in " << timer << std::endl;
+
+    if (!solver.factorize()) return EXIT_FAILURE;
+
+    // the exact solution is x = (1,...,1), so b holds the row sums
+    VectorX b(n), x(n);
+    for (int i = 0; i < n; ++i)
+    {
+        b(i) = 0.0;
+        for (int j = 0; j < n; ++j) b(i) += entry(i, j, n);
+    }
+
+    timer.start();
+    solver.solve(b, x);
+    timer.stop();
+    std::cout << "Solved in " << timer << ", max error "
+              << (x.array() - 1.0).abs().maxCoeff() << std::endl;
+
+    if (in_core)
+    {
+        MatrixXX A(n, n);
+        for (int j = 0; j < n; ++j)
+            for (int i = 0; i < n; ++i) A(i, j) = entry(i, j, n);
+
+        timer.start();
+        Eigen::PartialPivLU<MatrixXX> lu(A);
+        timer.stop();
+
+        const double m = n;
+        std::cout << "In-core LU: " << timer << " ("
+                  << 2.0 / 3.0 * m * m * m / timer.elapsed() * 1e-6
+                  << " GFLOP/s)" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+//=============================================================================
@@ -0,0 +1,123 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "heat_field.h"
+#include "quadtree_field.h"
+#include "thread_team.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+//=============================================================================
+
+/// one test case: a grid resolution and an initial state
+struct Case
+{
+    const char* name;
+    int         size;
+    std::function<float(double _x, double _y)> f;
+};
+
+//-----------------------------------------------------------------------------
+
+/// largest difference of the values of _a and _b
+float max_difference(const HeatField& _a, const HeatField& _b)
+{
+    float d = 0.0f;
+    for (int i = 0; i < _a.resolution(); ++i)
+        for (int j = 0; j < _a.resolution(); ++j)
+            d = std::max(d, std::abs(_a(i, j) - _b(i, j)));
+    return d;
+}
+
+//-----------------------------------------------------------------------------
+
+/// Runs the explicit Euler steps of the quadtree and of the uniform grid
+/// from the same state. The quadtree has to follow the change of the
+/// uniform field up to 10%, which also catches blocks that are not
+/// stepped at all.
+bool check(const Case& _case, ThreadTeam& _team)
+{
+    const int   n = _case.size, steps = 400;
+    const float time_step = 0.5f;
+
+    HeatField uniform(&_team), start(&_team), adaptive(&_team);
+    uniform.resize(n);
+    start.resize(n);
+    adaptive.resize(n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            uniform(i, j) = start(i, j) =
+                _case.f(double(i) / (n - 1), double(j) / (n - 1));
+
+    QuadtreeField quadtree(&_team);
+    quadtree.load(start);
+    quadtree.step(time_step, steps);
+    quadtree.store(adaptive);
+    uniform.explicit_euler_steps(time_step, steps);
+
+    // store() only writes the interior points
+    for (int k = 0; k < n; ++k)
+    {
+        adaptive(0, k) = uniform(0, k);
+        adaptive(n - 1, k) = uniform(n - 1, k);
+        adaptive(k, 0) = uniform(k, 0);
+        adaptive(k, n - 1) = uniform(k, n - 1);
+    }
+
+    const float change = max_difference(uniform, start);
+    const float error  = max_difference(uniform, adaptive);
+    const bool  ok     = change > 0.0f && error <= 0.1f * change;
+
+    std::cout << std::setw(14) << _case.name << std::setw(6) << n
+              << std::setw(8) << quadtree.n_blocks() << std::scientific
+              << std::setprecision(2) << std::setw(11) << change
+              << std::setw(11) << error << std::setw(6)
+              << (ok ? "ok" : "FAIL") << std::endl;
+    return ok;
+}
+
+//=============================================================================
+
+int main()
+{
+    // the leaves are split over at least two threads
+    ThreadTeam team(std::max(2u, std::thread::hardware_concurrency()));
+
+    auto hot_edge = [](double _x, double) { return _x == 0.0 ? 0.1f : 0.0f; };
+    auto smooth   = [](double _x, double _y) {
+        return float(0.002 * std::sin(M_PI * _x) * std::sin(M_PI * _y));
+    };
+    auto spot = [](double _x, double _y) {
+        const double dx = _x - 0.3, dy = _y - 0.6;
+        return dx * dx + dy * dy < 0.05 * 0.05 ? 0.2f : 0.0f;
+    };
+
+    // single leaves (the smallest grids, and a smooth field that is not
+    // refined), resampled grids, and a refined quadtree
+    const Case cases[] = {{"hot edge", 10, hot_edge},
+                          {"hot edge", 17, hot_edge},
+                          {"smooth", 50, smooth},
+                          {"hot edge", 50, hot_edge},
+                          {"spot", 257, spot}};
+
+    std::cout << team.size() << " threads\n"
+              << "          case  size  blocks     change      error\n";
+
+    bool ok = true;
+    for (const Case& c : cases) ok = check(c, team) && ok;
+
+    return ok ? 0 : 1;
+}
+
+//=============================================================================
@@ -0,0 +1,292 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "heat_field.h"
+#include "thread_team.h"
+
+#include <pmp/Timer.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//=============================================================================
+
+/// benchmark settings
+struct Settings
+{
+    Settings()
+        : size(4096), max_size(8192), max_threads(0), steps(20), batch(1),
+          depth(1), repetitions(5)
+    {
+    }
+
+    int size;        ///< grid resolution of the weak scaling base case
+    int max_size;    ///< largest grid of the strong scaling sweep
+    int max_threads; ///< largest team (0: hardware threads)
+    int steps;       ///< time steps per timed run
+    int batch;       ///< steps per explicit_euler_steps() call
+    int depth;       ///< steps fused into one pass (temporal blocking)
+    int repetitions; ///< timed runs, the median is reported
+};
+
+/// one grid size on one team
+struct Measurement
+{
+    std::string kind;      ///< "strong" or "weak"
+    int         size;      ///< grid resolution
+    int         threads;   ///< team size
+    double      step_time; ///< median time per step [ms]
+    double      updates;   ///< grid point updates per second [1e9/s]
+    double      speedup;   ///< relative to one thread (weak: scaled)
+    double      efficiency;
+    bool        exact;     ///< bit-identical to the single thread result?
+};
+
+//-----------------------------------------------------------------------------
+
+/// a smooth initial state with a hot boundary
+void initialize(HeatField& _field)
+{
+    const int n = _field.resolution();
+    for (int i = 0; i < n; ++i)
+    {
+        float* u = _field.row(i);
+        for (int j = 0; j < n; ++j)
+            u[j] = (i == 0 || j == 0)
+                       ? 1.0f
+                       : std::sin(0.01f * i) * std::cos(0.02f * j);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+/// sum of all values, to compare runs
+double checksum(const HeatField& _field)
+{
+    double sum = 0.0;
+    const int n = _field.resolution();
+    for (int i = 0; i < n; ++i)
+    {
+        const float* u = _field.row(i);
+        for (int j = 0; j < n; ++j) sum += u[j];
+    }
+    return sum;
+}
+
+//-----------------------------------------------------------------------------
+
+/// time _settings.steps steps on an _size x _size grid with _threads threads,
+/// returns the median time per step [ms] and the checksum of the last run
+double measure(int _size, int _threads, const Settings& _settings,
+               double& _checksum)
+{
+    ThreadTeam team(_threads);
+    HeatField  field(&team);
+    field.resize(_size);
+    field.set_block_depth(_settings.depth);
+
+    std::vector<double> times;
+    for (int r = 0; r <= _settings.repetitions; ++r)
+    {
+        initialize(field);
+
+        pmp::Timer timer;
+        timer.start();
+        for (int s = 0; s < _settings.steps; s += _settings.batch)
+            field.explicit_euler_steps(
+                0.5f, std::min(_settings.batch, _settings.steps - s));
+        timer.stop();
+
+        // the first run is a warm-up
+        if (r > 0) times.push_back(timer.elapsed() / _settings.steps);
+    }
+
+    _checksum = checksum(field);
+
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+//-----------------------------------------------------------------------------
+
+/// 1, 2, 4, ..., and _max_threads
+std::vector<int> team_sizes(int _max_threads)
+{
+    std::vector<int> sizes;
+    for (int t = 1; t < _max_threads; t *= 2) sizes.push_back(t);
+    sizes.push_back(_max_threads);
+    return sizes;
+}
+
+//-----------------------------------------------------------------------------
+
+void print(const Measurement& _m)
+{
+    std::cout << std::setw(7) << _m.kind << std::setw(8) << _m.size
+              << std::setw(8) << _m.threads << std::fixed
+              << std::setprecision(3) << std::setw(12) << _m.step_time
+              << std::setw(10) << _m.updates << std::setprecision(2)
+              << std::setw(9) << _m.speedup << std::setw(8)
+              << 100.0 * _m.efficiency << "%" << std::setw(7)
+              << (_m.exact ? "yes" : "NO") << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+
+void write_json(const std::string& _filename, const Settings& _settings,
+                const std::vector<Measurement>& _measurements)
+{
+    std::ofstream ofs(_filename.c_str());
+    if (!ofs)
+    {
+        std::cerr << "Cannot write " << _filename << std::endl;
+        return;
+    }
+
+    ofs << "{\n  \"steps\": " << _settings.steps
+        << ",\n  \"batch\": " << _settings.batch
+        << ",\n  \"depth\": " << _settings.depth
+        << ",\n  \"repetitions\": " << _settings.repetitions
+        << ",\n  \"hardware_threads\": " << std::thread::hardware_concurrency()
+        << ",\n  \"measurements\": [\n";
+    for (size_t i = 0; i < _measurements.size(); ++i)
+    {
+        const Measurement& m = _measurements[i];
+        ofs << "    {\"kind\": \"" << m.kind << "\", \"size\": " << m.size
+            << ", \"threads\": " << m.threads
+            << ", \"step_ms\": " << m.step_time
+            << ", \"gupdates\": " << m.updates
+            << ", \"speedup\": " << m.speedup
+            << ", \"efficiency\": " << m.efficiency
+            << ", \"exact\": " << (m.exact ? "true" : "false") << "}"
+            << (i + 1 < _measurements.size() ? ",\n" : "\n");
+    }
+    ofs << "  ]\n}\n";
+}
+
+//=============================================================================
+
+int main(int argc, char** argv)
+{
+    Settings    settings;
+    std::string output;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--size") && i + 1 < argc)
+            settings.size = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--max-size") && i + 1 < argc)
+            settings.max_size = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+            settings.max_threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--steps") && i + 1 < argc)
+            settings.steps = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--batch") && i + 1 < argc)
+            settings.batch = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--depth") && i + 1 < argc)
+            settings.depth = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--reps") && i + 1 < argc)
+            settings.repetitions = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--out") && i + 1 < argc)
+            output = argv[++i];
+        else
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--size <n>] [--max-size <n>] [--threads <t>]"
+                         " [--steps <k>] [--batch <k>] [--depth <k>]"
+                         " [--reps <runs>]"
+                         " [--out <file.json>]\n";
+            return 1;
+        }
+    }
+
+    if (settings.max_threads <= 0)
+        settings.max_threads =
+            std::max(1u, std::thread::hardware_concurrency());
+    settings.steps       = std::max(settings.steps, 1);
+    settings.batch       = std::max(settings.batch, 1);
+    settings.depth       = std::max(settings.depth, 1);
+    settings.repetitions = std::max(settings.repetitions, 1);
+
+    const std::vector<int>   teams = team_sizes(settings.max_threads);
+    std::vector<Measurement> measurements;
+
+    std::cout << "   kind    size threads   ms/step  GUpd/s  speedup    eff."
+                 "  exact\n";
+
+    // strong scaling: fixed grids, growing team
+    for (int n = settings.size; n <= settings.max_size; n *= 2)
+    {
+        double serial_time = 0.0, serial_checksum = 0.0;
+        for (int t : teams)
+        {
+            Measurement m;
+            double      sum;
+            m.kind      = "strong";
+            m.size      = n;
+            m.threads   = t;
+            m.step_time = measure(n, t, settings, sum);
+            if (t == 1)
+            {
+                serial_time     = m.step_time;
+                serial_checksum = sum;
+            }
+            m.updates    = double(n) * n / m.step_time * 1e-6;
+            m.speedup    = serial_time / m.step_time;
+            m.efficiency = m.speedup / t;
+            m.exact      = (sum == serial_checksum);
+            measurements.push_back(m);
+            print(m);
+        }
+    }
+
+    // weak scaling: constant number of grid points per thread
+    double serial_updates = 0.0;
+    for (int t : teams)
+    {
+        // round to full cache lines
+        const int n =
+            (int(settings.size * std::sqrt(double(t))) + 15) / 16 * 16;
+
+        Measurement m;
+        double      sum, reference = 0.0;
+        m.kind      = "weak";
+        m.size      = n;
+        m.threads   = t;
+        m.step_time = measure(n, t, settings, sum);
+        m.updates   = double(n) * n / m.step_time * 1e-6;
+        if (t == 1) serial_updates = m.updates;
+        m.speedup    = m.updates / serial_updates;
+        m.efficiency = m.speedup / t;
+
+        // the exactness check needs a serial run of the same size
+        if (t > 1) measure(n, 1, settings, reference);
+        m.exact = (t == 1 || sum == reference);
+
+        measurements.push_back(m);
+        print(m);
+    }
+
+    if (!output.empty())
+    {
+        write_json(output, settings, measurements);
+        std::cout << "Results written to " << output << std::endl;
+    }
+
+    return 0;
+}
+
+//=============================================================================
@@ -0,0 +1,188 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "thread_team.h"
+#include "volume_field.h"
+
+#include <pmp/Timer.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+//=============================================================================
+
+/// benchmark settings
+struct Settings
+{
+    Settings() : size(512), threads(0), steps(10), repetitions(3) {}
+
+    int size;        ///< grid resolution
+    int threads;     ///< team size (0: hardware threads)
+    int steps;       ///< time steps per timed run
+    int repetitions; ///< timed runs, the median is reported
+};
+
+//-----------------------------------------------------------------------------
+
+/// a smooth initial state with a hot boundary
+void initialize(VolumeField& _field)
+{
+    const int n = _field.resolution();
+    for (int k = 0; k < n; ++k)
+        for (int i = 0; i < n; ++i)
+        {
+            float* u = _field.row(i, k);
+            for (int j = 0; j < n; ++j)
+                u[j] = (i == 0 || j == 0 || k == 0)
+                           ? 1.0f
+                           : std::sin(0.01f * i) * std::cos(0.02f * j) *
+                                 std::cos(0.03f * k);
+        }
+}
+
+//-----------------------------------------------------------------------------
+
+/// median of _settings.repetitions runs of _run() [ms], after a warm-up
+template <class Run>
+double median_time(const Settings& _settings, Run _run)
+{
+    std::vector<double> times;
+    for (int r = 0; r <= _settings.repetitions; ++r)
+    {
+        pmp::Timer timer;
+        timer.start();
+        _run();
+        timer.stop();
+        if (r > 0) times.push_back(timer.elapsed());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+//-----------------------------------------------------------------------------
+
+/// time per step [ms] of the stencil with _tile_rows rows per tile
+double stencil_time(VolumeField& _field, int _tile_rows,
+                    const Settings& _settings)
+{
+    _field.set_tile_rows(_tile_rows);
+    initialize(_field);
+    return median_time(_settings,
+                       [&]() {
+                           _field.explicit_euler_steps(0.5f,
+                                                       _settings.steps);
+                       }) /
+           _settings.steps;
+}
+
+//-----------------------------------------------------------------------------
+
+/// time [ms] to copy _n floats from _in to _out, each thread its own slab
+/// of the planes, as the memory bandwidth the stencil can reach
+double copy_time(ThreadTeam& _team, const float* _in, float* _out, size_t _n,
+                 const Settings& _settings)
+{
+    return median_time(_settings, [&]() {
+        _team.run([&](int _thread) {
+            int begin, end;
+            ThreadTeam::band(0, _settings.size, _team.size(), _thread, begin,
+                             end);
+            const size_t plane = _n / _settings.size;
+            const float* HEAT_RESTRICT in  = _in + begin * plane;
+            float* HEAT_RESTRICT       out = _out + begin * plane;
+            for (size_t j = 0; j < (end - begin) * plane; ++j)
+                out[j] = in[j];
+        });
+    });
+}
+
+//=============================================================================
+
+int main(int argc, char** argv)
+{
+    Settings settings;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--size") && i + 1 < argc)
+            settings.size = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+            settings.threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--steps") && i + 1 < argc)
+            settings.steps = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--reps") && i + 1 < argc)
+            settings.repetitions = atoi(argv[++i]);
+        else
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--size <n>] [--threads <t>] [--steps <k>]"
+                         " [--reps <runs>]\n";
+            return 1;
+        }
+    }
+
+    if (settings.threads <= 0)
+        settings.threads = std::max(1u, std::thread::hardware_concurrency());
+    settings.size        = std::max(settings.size, 3);
+    settings.steps       = std::max(settings.steps, 1);
+    settings.repetitions = std::max(settings.repetitions, 1);
+
+    const int    n      = settings.size;
+    const double points = double(n) * n * n;
+
+    ThreadTeam  team(settings.threads);
+    VolumeField field(&team);
+    field.resize(n);
+
+    // reference: a copy reads and writes every value once, the least
+    // traffic a stencil step can have
+    std::vector<float> in(size_t(n) * n * n), out(in.size());
+    team.run([&](int _thread) {
+        int begin, end;
+        ThreadTeam::band(0, n, team.size(), _thread, begin, end);
+        const size_t plane = size_t(n) * n;
+        std::fill(in.begin() + begin * plane, in.begin() + end * plane, 1.0f);
+        std::fill(out.begin() + begin * plane, out.begin() + end * plane,
+                  0.0f);
+    });
+    const double copy = copy_time(team, in.data(), out.data(), in.size(),
+                                  settings);
+    in.clear();
+    in.shrink_to_fit();
+    out.clear();
+    out.shrink_to_fit();
+
+    std::cout << n << "^3 grid, " << team.size() << " threads, "
+              << settings.steps << " steps\n"
+              << std::fixed << std::setprecision(2) << "copy: " << copy
+              << " ms, " << 2.0 * 4.0 * points / copy * 1e-6 << " GB/s\n\n"
+              << "   blocking  tile rows   ms/step  GUpd/s    GB/s  of copy\n";
+
+    // without blocking (one tile of all rows) and with 2.5D blocking
+    const int tiles[2] = {n, 0};
+    const char* names[2] = {"none", "2.5D"};
+    for (int t = 0; t < 2; ++t)
+    {
+        const double time = stencil_time(field, tiles[t], settings);
+        std::cout << std::setw(11) << names[t] << std::setw(11)
+                  << field.tile_rows() << std::setw(10) << time
+                  << std::setw(8) << points / time * 1e-6 << std::setw(8)
+                  << 2.0 * 4.0 * points / time * 1e-6 << std::setw(8)
+                  << 100.0 * copy / time << "%" << std::endl;
+    }
+
+    return 0;
+}
+
+//=============================================================================
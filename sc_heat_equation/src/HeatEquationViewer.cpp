@@ -15,15 +15,39 @@
 
 #include <Eigen/Dense>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "band_cholesky.h"
 #include "rainbow.h"
 
 using namespace pmp;
 
 //== IMPLEMENTATION ==========================================================
 
+/// directory of the band Cholesky factor files: $DIFFUSION_CACHE_DIR if it
+/// is set (empty: keep the factors in memory only), otherwise the per-user
+/// cache directory
+static std::string factor_directory()
+{
+  const char* directory = getenv("DIFFUSION_CACHE_DIR");
+  if (directory) return directory;
+  return FactorizationCache::user_directory("diffusion");
+}
+
+//-----------------------------------------------------------------------------
+
 HeatEquationViewer::HeatEquationViewer(const char* _title, int _width,
                                        int _height)
-    : Window(_title, _width, _height)
+    : Window(_title, _width, _height), field_(&team_),
+      adi_(&team_),
+      rkl_(&team_),
+      spectral_(&team_),
+      parareal_(&team_),
+      amr_(&team_),
+      volume_(&team_),
+      factorizations_(MAX_EQUILIBRIUM_BYTES, factor_directory())
 {
   // initialize OpenGL stuff
   init();
@@ -34,6 +58,16 @@ HeatEquationViewer::HeatEquationViewer(const char* _title, int _width,
   time_step_        = 0.5;
   button_down_      = false;
   integration_time_ = 0.0;
+  steps_per_frame_  = 1;
+  integrator_       = EXPLICIT_EULER;
+  volume_mode_      = false;
+  volume_slice_     = 0;
+
+  // multigrid is linear in the number of grid points
+  equilibrium_solver_ = MULTIGRID;
+
+  // fuse up to 8 steps into one pass over the field
+  field_.set_block_depth(8);
 
   // initialize grid
   generate_grid(50);
@@ -125,86 +159,348 @@ void HeatEquationViewer::init()
 
 void HeatEquationViewer::generate_grid(int _resolution)
 {
-  // adjust size of grid
-  grid_resolution_   = _resolution;
-  float grid_spacing = 1.0 / (grid_resolution_ - 1);
+  // adjust size of grid and render mesh
+  grid_resolution_      = _resolution;
+  mesh_resolution_      = std::min(_resolution, int(MAX_MESH_RESOLUTION));
+  requested_resolution_ = _resolution;
+
+  const int m            = mesh_resolution_;
+  float     grid_spacing = 1.0 / (m - 1);
 
   std::cout << "Construct " << grid_resolution_ << "x" << grid_resolution_
-            << " grid..." << std::flush;
+            << " grid";
+  if (m < grid_resolution_)
+    std::cout << " (rendered as " << m << "x" << m << ")";
+  std::cout << "..." << std::flush;
 
   // allocate memory for points and normal vectors
-  grid_points_.resize(grid_resolution_ * grid_resolution_);
-  grid_normals_.resize(grid_resolution_ * grid_resolution_);
+  grid_points_.resize(m * m);
+  grid_normals_.resize(m * m);
+  mesh_heights_.assign(m * m, 0.0f);
 
   // (x,y) values are from unit square [0,1]x[0,1]
   int i, j;
-  float x, y;
-  for (i = 0, x = 0.0; i < grid_resolution_; ++i, x += grid_spacing)
+  for (i = 0; i < m; ++i)
   {
-    for (j = 0, y = 0.0; j < grid_resolution_; ++j, y += grid_spacing)
+    for (j = 0; j < m; ++j)
     {
-      grid_point(i, j)  = vec3(x, y, 0.0);
+      grid_point(i, j)  = vec3(i * grid_spacing, j * grid_spacing, 0.0);
       grid_normal(i, j) = vec3(0.0, 0.0, 1.0);
     }
   }
 
+  // Vertex a is at a / (m-1), grid row i at i / (N-1). The block of vertex
+  // a are the grid rows closer to it than to any other vertex, i.e. from
+  // (a - 1/2) (N-1)/(m-1) up to (a + 1/2) (N-1)/(m-1). For m = N every
+  // block is a single row.
+  const int64_t num = grid_resolution_ - 1, den = 2 * int64_t(m - 1);
+  mesh_blocks_.resize(m + 1);
+  for (i = 0; i <= m; ++i)
+  {
+    const int64_t k = (2 * int64_t(i) - 1) * num;
+    mesh_blocks_[i] =
+        std::min<int64_t>(k > 0 ? (k + den - 1) / den : 0, grid_resolution_);
+  }
+
   // compute indices for OpenGL vertex array rendering
   grid_indices_.clear();
-  grid_indices_.reserve((grid_resolution_ - 1) * (grid_resolution_ - 1) * 4);
-  for (i = 0; i < grid_resolution_ - 1; ++i)
+  grid_indices_.reserve((m - 1) * (m - 1) * 4);
+  for (i = 0; i < m - 1; ++i)
   {
-    for (j = 0; j < grid_resolution_ - 1; ++j)
+    for (j = 0; j < m - 1; ++j)
     {
-      grid_indices_.push_back((i + 0) * grid_resolution_ + (j + 0));
-      grid_indices_.push_back((i + 1) * grid_resolution_ + (j + 0));
-      grid_indices_.push_back((i + 1) * grid_resolution_ + (j + 1));
-      grid_indices_.push_back((i + 0) * grid_resolution_ + (j + 1));
+      grid_indices_.push_back((i + 0) * m + (j + 0));
+      grid_indices_.push_back((i + 1) * m + (j + 0));
+      grid_indices_.push_back((i + 1) * m + (j + 1));
+      grid_indices_.push_back((i + 0) * m + (j + 1));
     }
   }
 
   std::cout << "done\n";
 
-  // reset velocities V and accelerations A
-  grid_velocities_.resize(grid_resolution_ * grid_resolution_);
-  grid_accelerations_.resize(grid_resolution_ * grid_resolution_);
-  for (int i = 0; i < grid_resolution_; ++i)
-    for (int j = 0; j < grid_resolution_; ++j) V(i, j) = A(i, j) = 0.0;
+  // reset the field
+  field_.resize(grid_resolution_);
+  clear_adaptive();
+  if (volume_mode_) load_volume();
+  mark_dirty();
 }
 
 //-----------------------------------------------------------------------------
 
-void HeatEquationViewer::update_normals()
+void HeatEquationViewer::set_field(
+    const std::function<double(double _x, double _y)>& _f)
 {
-  vec3 dx, dy;
+  // each thread fills a band of rows
+  team_.run([this, &_f](int _thread) {
+    int begin, end;
+    ThreadTeam::band(0, grid_resolution_, team_.size(), _thread, begin, end);
+
+    for (int i = begin; i < end; ++i)
+      for (int j = 0; j < grid_resolution_; ++j)
+        U(i, j) = _f(X(i, j), Y(i, j));
+  });
+
+  clear_adaptive();
+  if (volume_mode_) load_volume();
+  mark_dirty();
+}
+
+//-----------------------------------------------------------------------------
 
-  for (int i = 0; i < grid_resolution_; ++i)
+void HeatEquationViewer::mark_dirty()
+{
+  dirty_rects_.clear();
+  mark_dirty(0, 0, grid_resolution_, grid_resolution_);
+}
+
+//-----------------------------------------------------------------------------
+
+void HeatEquationViewer::mark_dirty(int _i0, int _j0, int _i1, int _j1)
+{
+  GridRect rect = {std::max(_i0, 0), std::max(_j0, 0),
+                   std::min(_i1, grid_resolution_),
+                   std::min(_j1, grid_resolution_)};
+  if (rect.i0 >= rect.i1 || rect.j0 >= rect.j1) return;
+
+  // nothing to do if the rectangle is already covered
+  for (const GridRect& r : dirty_rects_)
+    if (r.i0 <= rect.i0 && r.j0 <= rect.j0 && rect.i1 <= r.i1 &&
+        rect.j1 <= r.j1)
+      return;
+
+  // too many rectangles: replace them by their bounding box
+  if (int(dirty_rects_.size()) >= MAX_DIRTY_RECTS)
   {
-    for (int j = 0; j < grid_resolution_; ++j)
+    for (const GridRect& r : dirty_rects_)
     {
-      // compute derivative in x
-      if (i - 1 >= 0 && i + 1 < grid_resolution_)
-        dx = grid_point(i + 1, j) - grid_point(i - 1, j);  // central difference
-      else if (i - 1 >= 0)
-        dx = grid_point(i, j) - grid_point(i - 1, j);  // backward difference
-      else
-        dx = grid_point(i + 1, j) - grid_point(i, j);  // forward difference
+      rect.i0 = std::min(rect.i0, r.i0);
+      rect.j0 = std::min(rect.j0, r.j0);
+      rect.i1 = std::max(rect.i1, r.i1);
+      rect.j1 = std::max(rect.j1, r.j1);
+    }
+    dirty_rects_.clear();
+  }
+
+  dirty_rects_.push_back(rect);
+}
 
-      // compute derivative in y
-      if (j - 1 >= 0 && j + 1 < grid_resolution_)
-        dy = grid_point(i, j + 1) - grid_point(i, j - 1);  // central difference
-      else if (j - 1 >= 0)
-        dy = grid_point(i, j) - grid_point(i, j - 1);  // backward difference
-      else
-        dy = grid_point(i, j + 1) - grid_point(i, j);  // forward difference
+//-----------------------------------------------------------------------------
+
+HeatEquationViewer::GridRect HeatEquationViewer::mesh_rect(
+    const GridRect& _rect) const
+{
+  // the vertex of grid row i is the last one whose block starts at or
+  // before i
+  auto vertex = [this](int _i) {
+    return int(std::upper_bound(mesh_blocks_.begin(), mesh_blocks_.end() - 1,
+                                _i) -
+               mesh_blocks_.begin()) -
+           1;
+  };
+
+  GridRect rect = {vertex(_rect.i0), vertex(_rect.j0), vertex(_rect.i1 - 1) + 1,
+                   vertex(_rect.j1 - 1) + 1};
+  return rect;
+}
 
-      // normal is cross product of tangents
-      grid_normal(i, j) = normalize(cross(dx, dy));
+//-----------------------------------------------------------------------------
+
+void HeatEquationViewer::update_heights(int _a, int _b0, int _b1)
+{
+  const int  m    = mesh_resolution_;
+  float*     z    = &mesh_heights_[size_t(_a) * m];
+  const int* cols = mesh_blocks_.data();
+  const int  i0 = mesh_blocks_[_a], i1 = mesh_blocks_[_a + 1];
+  int        b, j;
+
+  if (m == grid_resolution_)
+  {
+    // render mesh = grid: copy
+    const float* u = field_.row(_a);
+    for (b = _b0; b < _b1; ++b) z[b] = u[b];
+  }
+  else
+  {
+    // Reduce each block to the value that deviates most from the block
+    // mean, its minimum or its maximum. Averaging would flatten peaks and
+    // dips that are narrower than a block, e.g. a brush stroke.
+    // First the columns of this block row are reduced over its rows, which
+    // runs over contiguous memory, then the columns of each block.
+    const int          j0 = cols[_b0], j1 = cols[_b1];
+    std::vector<float> lo(field_.row(i0) + j0, field_.row(i0) + j1);
+    std::vector<float> hi(lo), sum(lo);
+
+    // two rows at a time, to halve the passes over the accumulators
+    int i = i0 + 1;
+    for (; i + 1 < i1; i += 2)
+    {
+      const float* HEAT_RESTRICT u0 = field_.row(i) + j0;
+      const float* HEAT_RESTRICT u1 = field_.row(i + 1) + j0;
+      float* HEAT_RESTRICT       l  = lo.data();
+      float* HEAT_RESTRICT       h  = hi.data();
+      float* HEAT_RESTRICT       s  = sum.data();
+      for (j = 0; j < j1 - j0; ++j)
+      {
+        l[j] = std::min(l[j], std::min(u0[j], u1[j]));
+        h[j] = std::max(h[j], std::max(u0[j], u1[j]));
+        s[j] += u0[j] + u1[j];
+      }
+    }
+    for (; i < i1; ++i)
+    {
+      const float* HEAT_RESTRICT u = field_.row(i) + j0;
+      float* HEAT_RESTRICT       l = lo.data();
+      float* HEAT_RESTRICT       h = hi.data();
+      float* HEAT_RESTRICT       s = sum.data();
+      for (j = 0; j < j1 - j0; ++j)
+      {
+        l[j] = std::min(l[j], u[j]);
+        h[j] = std::max(h[j], u[j]);
+        s[j] += u[j];
+      }
     }
+
+    for (b = _b0; b < _b1; ++b)
+    {
+      float l = lo[cols[b] - j0], h = hi[cols[b] - j0], s = 0.0f;
+      for (j = cols[b] - j0; j < cols[b + 1] - j0; ++j)
+      {
+        l = std::min(l, lo[j]);
+        h = std::max(h, hi[j]);
+        s += sum[j];
+      }
+      const float mean = s / (float(i1 - i0) * (cols[b + 1] - cols[b]));
+      z[b]             = (h - mean >= mean - l) ? h : l;
+    }
+  }
+
+  for (b = _b0; b < _b1; ++b) grid_point(_a, b)[2] = z[b];
+}
+
+//-----------------------------------------------------------------------------
+
+void HeatEquationViewer::update_normals(int _a, int _b0, int _b1)
+{
+  const int m = mesh_resolution_;
+
+  // The normal is the cross product of the central differences
+  // (c, 0, p) and (0, c, q) along the rows and columns, with c the vertex
+  // distance times 2. Normalized, it is (-p, -q, c) / |(-p, -q, c)|.
+  //
+  // At the boundary the missing neighbor is extrapolated linearly, which
+  // turns the central difference into twice the one-sided difference and
+  // gives the same normal as the one-sided tangent.
+  const float c = 2.0f / (m - 1);
+
+  const float* HEAT_RESTRICT mid  = &mesh_heights_[size_t(_a) * m];
+  const float* HEAT_RESTRICT up   = mid - (_a > 0 ? m : 0);
+  const float* HEAT_RESTRICT down = mid + (_a < m - 1 ? m : 0);
+  const float  sp = (_a > 0 && _a < m - 1) ? 1.0f : 2.0f;
+
+  float* HEAT_RESTRICT normal = grid_normal(_a, 0).data();
+
+  auto set = [&](int _b, float _p, float _q) {
+    const float s      = 1.0f / std::sqrt(_p * _p + _q * _q + c * c);
+    normal[3 * _b + 0] = -_p * s;
+    normal[3 * _b + 1] = -_q * s;
+    normal[3 * _b + 2] = c * s;
+  };
+
+  // peel off the boundary columns
+  int b0 = _b0, b1 = _b1;
+  if (b0 == 0)
+  {
+    set(0, sp * (down[0] - up[0]), 2.0f * (mid[1] - mid[0]));
+    ++b0;
+  }
+  if (b1 == m && b0 < b1)
+  {
+    set(m - 1, sp * (down[m - 1] - up[m - 1]),
+        2.0f * (mid[m - 1] - mid[m - 2]));
+    --b1;
+  }
+
+  // interior columns, branch-free
+  for (int b = b0; b < b1; ++b)
+  {
+    const float p = sp * (down[b] - up[b]);
+    const float q = mid[b + 1] - mid[b - 1];
+    const float s = 1.0f / std::sqrt(p * p + q * q + c * c);
+    normal[3 * b + 0] = -p * s;
+    normal[3 * b + 1] = -q * s;
+    normal[3 * b + 2] = c * s;
   }
 }
 
 //-----------------------------------------------------------------------------
 
+void HeatEquationViewer::update_mesh()
+{
+  const int m = mesh_resolution_;
+
+  // the vertices covering the dirty parts of the grid
+  std::vector<GridRect> rects;
+  for (const GridRect& r : dirty_rects_) rects.push_back(mesh_rect(r));
+
+  // The rectangles may overlap, e.g. for consecutive brush positions, so
+  // they are not split one by one. Each thread takes a band of the rows
+  // they span, and updates each of its rows once, over the merged column
+  // ranges of the rectangles covering it. So no vertex is written by two
+  // threads.
+  auto update_rows = [this](const std::vector<GridRect>& _rects,
+                            void (HeatEquationViewer::*_update)(int, int,
+                                                                int)) {
+    int a0 = mesh_resolution_, a1 = 0;
+    for (const GridRect& r : _rects)
+    {
+      a0 = std::min(a0, r.i0);
+      a1 = std::max(a1, r.i1);
+    }
+
+    team_.run([&](int _thread) {
+      int begin, end;
+      ThreadTeam::band(a0, a1, team_.size(), _thread, begin, end);
+
+      std::vector<std::pair<int, int>> spans;
+      for (int a = begin; a < end; ++a)
+      {
+        spans.clear();
+        for (const GridRect& r : _rects)
+          if (r.i0 <= a && a < r.i1)
+            spans.push_back(std::make_pair(r.j0, r.j1));
+        std::sort(spans.begin(), spans.end());
+
+        for (size_t k = 0; k < spans.size();)
+        {
+          int b0 = spans[k].first, b1 = spans[k].second;
+          for (++k; k < spans.size() && spans[k].first <= b1; ++k)
+            b1 = std::max(b1, spans[k].second);
+          (this->*_update)(a, b0, b1);
+        }
+      }
+    });
+  };
+
+  // the heights of all dirty rectangles have to be updated before any
+  // normal is computed
+  update_rows(rects, &HeatEquationViewer::update_heights);
+
+  // normals depend on the neighbors, so they change one vertex beyond
+  // the rectangles
+  for (GridRect& r : rects)
+  {
+    r.i0 = std::max(r.i0 - 1, 0);
+    r.j0 = std::max(r.j0 - 1, 0);
+    r.i1 = std::min(r.i1 + 1, m);
+    r.j1 = std::min(r.j1 + 1, m);
+  }
+  update_rows(rects, &HeatEquationViewer::update_normals);
+
+  dirty_rects_.clear();
+}
+
+//-----------------------------------------------------------------------------
+
 void HeatEquationViewer::time_integration()
 {
   // set up time counters
@@ -215,8 +511,24 @@ void HeatEquationViewer::time_integration()
   Timer timer;
   timer.start();
 
-  // to one step of time integration
-  explicit_euler_step();
+  // steps_per_frame_ steps of time integration
+  if (volume_mode_)
+    volume_step();
+  else if (integrator_ == EXPLICIT_EULER)
+    explicit_euler_step();
+  else if (integrator_ == RKL2)
+    super_time_step();
+  else if (integrator_ == EXPONENTIAL)
+    exponential_step();
+  else if (integrator_ == PARAREAL)
+    parareal_step();
+  else if (integrator_ == ADAPTIVE)
+    adaptive_step();
+  else
+    implicit_step();
+
+  // the other integrators change field_, the quadtree is reloaded from it
+  if (volume_mode_ || integrator_ != ADAPTIVE) clear_adaptive();
 
   // stop timer, compute elapsed time
   timer.stop();
@@ -228,8 +540,8 @@ void HeatEquationViewer::time_integration()
     accumulated_time  = 0.0;
   }
 
-  // update the grid
-  update_normals();
+  // the mesh is updated when the next frame is drawn
+  mark_dirty();
 }
 
 //-----------------------------------------------------------------------------
@@ -263,25 +575,123 @@ void HeatEquationViewer::processImGUI()
     if (ImGui::Button("Equilibrium"))
     {
       solve_equilibrium();
-      update_normals();
+      mark_dirty();
     }
     ImGui::PopItemWidth();
 
     ImGui::Spacing();
     ImGui::Spacing();
 
+    int integrator = integrator_;
+    ImGui::Text("Integrator:");
+    ImGui::RadioButton("Explicit Euler", &integrator, EXPLICIT_EULER);
+    ImGui::RadioButton("Implicit Euler", &integrator, IMPLICIT_EULER);
+    ImGui::RadioButton("Crank-Nicolson", &integrator, CRANK_NICOLSON);
+    ImGui::RadioButton("ADI", &integrator, ADI);
+    ImGui::RadioButton("Super Time-Stepping (RKL2)", &integrator, RKL2);
+    ImGui::RadioButton("Exponential (DST)", &integrator, EXPONENTIAL);
+    ImGui::RadioButton("Parareal (Explicit Euler)", &integrator, PARAREAL);
+    ImGui::RadioButton("Adaptive Quadtree (Explicit Euler)", &integrator,
+                       ADAPTIVE);
+    if (integrator != integrator_)
+    {
+      integrator_ = Integrator(integrator);
+
+      // explicit Euler is unstable beyond the slider range
+      if (integrator_ == EXPLICIT_EULER || integrator_ == PARAREAL ||
+          integrator_ == ADAPTIVE)
+        time_step_ = std::min(time_step_, 1.2f);
+    }
+
+    if (integrator_ == PARAREAL)
+    {
+      int slices = parareal_.slices();
+      ImGui::PushItemWidth(100);
+      ImGui::SliderInt("Time Slices", &slices, 1, 64);
+      ImGui::PopItemWidth();
+      parareal_.set_slices(slices);
+    }
+
+    if (integrator_ == ADAPTIVE)
+    {
+      float tolerance = amr_.tolerance();
+      ImGui::PushItemWidth(100);
+      ImGui::SliderFloat("Refinement Tolerance", &tolerance, 0.0001f, 0.1f,
+                         "%.4f", 3.0f);
+      ImGui::PopItemWidth();
+      amr_.set_tolerance(tolerance);
+    }
+
+    ImGui::Spacing();
+    ImGui::Spacing();
+
+    // the 3D field uses explicit Euler, whatever integrator is chosen
+    bool volume_mode = volume_mode_;
+    ImGui::Checkbox("3D Volume (Explicit Euler)", &volume_mode);
+    if (volume_mode != volume_mode_)
+    {
+      volume_mode_ = volume_mode;
+      if (volume_mode_)
+      {
+        volume_slice_ = grid_resolution_ / 2;
+        load_volume();
+      }
+    }
+    if (volume_mode_)
+    {
+      ImGui::PushItemWidth(100);
+      if (ImGui::SliderInt("Slice (z)", &volume_slice_, 0,
+                           grid_resolution_ - 1))
+        show_slice();
+      ImGui::PopItemWidth();
+    }
+
+    ImGui::Spacing();
+    ImGui::Spacing();
+
+    int equilibrium_solver = equilibrium_solver_;
+    ImGui::Text("Equilibrium Solver:");
+    ImGui::RadioButton("Band Cholesky", &equilibrium_solver, BAND_CHOLESKY);
+    ImGui::RadioButton("Multigrid", &equilibrium_solver, MULTIGRID);
+    equilibrium_solver_ = EquilibriumSolver(equilibrium_solver);
+
+    ImGui::Spacing();
+    ImGui::Spacing();
+
+    // the implicit integrators are stable for any time step, RKL2 adds
+    // stages as needed, and the exponential integrator is exact
+    const bool is_explicit = (integrator_ == EXPLICIT_EULER ||
+                              integrator_ == PARAREAL ||
+                              integrator_ == ADAPTIVE);
+    float max_time_step = is_explicit ? 1.2f : 120.0f;
+
+    // the 7-point stencil is stable up to 2/3
+    if (volume_mode_)
+    {
+      max_time_step = 0.66f;
+      time_step_    = std::min(time_step_, max_time_step);
+    }
     ImGui::PushItemWidth(100);
-    ImGui::SliderFloat("Time Step", &time_step_, 0.01f, 1.2f, "%.2f", 1.5);
+    ImGui::SliderFloat("Time Step", &time_step_, 0.01f, max_time_step, "%.2f",
+                       is_explicit || volume_mode_ ? 1.5f : 3.0f);
+    ImGui::SliderInt("Steps / Frame", &steps_per_frame_, 1, 500);
+    int depth = field_.block_depth();
+    ImGui::SliderInt("Block Depth", &depth, 1, 16);
+    if (depth != field_.block_depth()) field_.set_block_depth(depth);
     ImGui::PopItemWidth();
 
     ImGui::Spacing();
     ImGui::Spacing();
 
+    // large grids take a while to allocate, so the grid is only resized
+    // when the slider is released
     ImGui::PushItemWidth(100);
-    int res = grid_resolution_;
-    ImGui::SliderInt("Grid Resolution", &res, 10, 100);
+    ImGui::SliderFloat("Grid Resolution", &requested_resolution_, 10,
+                       MAX_RESOLUTION, "%.0f", 3.0f);
+    const bool resizing = ImGui::IsItemActive();
     ImGui::PopItemWidth();
-    if (res != grid_resolution_) generate_grid(res);
+    const int res = int(requested_resolution_ + 0.5f);
+    if (!resizing && res != grid_resolution_) generate_grid(res);
 
     ImGui::Spacing();
     ImGui::Spacing();
@@ -292,6 +702,19 @@ void HeatEquationViewer::processImGUI()
     ImGui::Spacing();
 
     if (animate_) ImGui::Text("Integration Time: %.3f ms", integration_time_);
+    if ((integrator_ == IMPLICIT_EULER || integrator_ == CRANK_NICOLSON) &&
+        implicit_.n_factorizations())
+      ImGui::Text("Factorization Time: %.1f ms",
+                  implicit_.factorization_time());
+    if (integrator_ == RKL2)
+      ImGui::Text("Stages / Step: %d", RKL_Integrator::stages(time_step_));
+    if (integrator_ == PARAREAL && animate_)
+      ImGui::Text("Parareal Iterations: %d / %d", parareal_.iterations(),
+                  std::min(parareal_.slices(), steps_per_frame_));
+    if (integrator_ == ADAPTIVE && !amr_.empty())
+      ImGui::Text("Blocks: %d (%.1f%% of the grid)", amr_.n_blocks(),
+                  100.0 * amr_.coverage());
+    ImGui::Text("Threads: %d", team_.size());
   }
 }
 
@@ -307,7 +730,7 @@ void HeatEquationViewer::keyboard(int key, int code, int action, int mods)
     case GLFW_KEY_SPACE:
     {
       solve_equilibrium();
-      update_normals();
+      mark_dirty();
       break;
     }
 
@@ -332,38 +755,26 @@ void HeatEquationViewer::keyboard(int key, int code, int action, int mods)
     // generate some test cases
     case GLFW_KEY_1:
     {
-      for (int i = 0; i < grid_resolution_; ++i)
-        for (int j = 0; j < grid_resolution_; ++j)
-          U(i, j) =
-              0.20 *
-              pow(sin(3.0 * M_PI * X(i, j)) * sin(3.0 * M_PI * Y(i, j)), 2.0);
-
-      update_normals();
+      set_field([](double x, double y) {
+        return 0.20 * pow(sin(3.0 * M_PI * x) * sin(3.0 * M_PI * y), 2.0);
+      });
       break;
     }
 
     case GLFW_KEY_2:
     {
-      for (int i = 0; i < grid_resolution_; ++i)
-        for (int j = 0; j < grid_resolution_; ++j)
-          U(i, j) =
-              0.1 * X(i, j) + 0.1 * Y(i, j) +
-              0.2 * pow(sin(4.0 * M_PI * X(i, j)) * sin(4.0 * M_PI * Y(i, j)),
-                        3.0);
-
-      update_normals();
+      set_field([](double x, double y) {
+        return 0.1 * x + 0.1 * y +
+               0.2 * pow(sin(4.0 * M_PI * x) * sin(4.0 * M_PI * y), 3.0);
+      });
       break;
     }
 
     case GLFW_KEY_3:
     {
-      for (int i = 0; i < grid_resolution_; ++i)
-        for (int j = 0; j < grid_resolution_; ++j)
-          U(i, j) =
-              0.20 *
-              pow(cos(1.0 * M_PI * X(i, j)) * sin(3.0 * M_PI * Y(i, j)), 2.0);
-
-      update_normals();
+      set_field([](double x, double y) {
+        return 0.20 * pow(cos(1.0 * M_PI * x) * sin(3.0 * M_PI * y), 2.0);
+      });
       break;
     }
 
@@ -453,22 +864,66 @@ void HeatEquationViewer::pick_point()
   vec3 p(p0[0] + l * (p1[0] - p0[0]), p0[1] + l * (p1[1] - p0[1]),
          p0[2] + l * (p1[2] - p0[2]));
 
+  // the brush lifts grid points within this distance of p
+  const float radius = 0.05;
+
+  // nothing to do if the brush misses the unit square (or the ray misses
+  // the plane)
+  if (!(std::abs(p[0] - 0.5f) < 0.5f + radius &&
+        std::abs(p[1] - 0.5f) < 0.5f + radius))
+    return;
+
+  // grid point (i,j) is at (i,j) / (N-1), so the brush covers the index
+  // rectangle [i0, i1) x [j0, j1). Only this rectangle is scanned.
+  const int   n  = grid_resolution_;
+  const float s  = n - 1;
+  const int   i0 = std::max(int(std::ceil((p[0] - radius) * s)), 0);
+  const int   j0 = std::max(int(std::ceil((p[1] - radius) * s)), 0);
+  const int   i1 = std::min(int(std::floor((p[0] + radius) * s)) + 1, n);
+  const int   j1 = std::min(int(std::floor((p[1] + radius) * s)) + 1, n);
+
   // lift point and some neighbors
-  for (int i = 0; i < grid_resolution_; ++i)
+  for (int i = i0; i < i1; ++i)
   {
-    for (int j = 0; j < grid_resolution_; ++j)
+    for (int j = j0; j < j1; ++j)
     {
       // q is grid point (i,j) with z-coordinate set to zero.
-      vec3 q = grid_point(i, j);
-      q[2]   = 0.0;
+      vec3 q(X(i, j), Y(i, j), 0.0);
 
       // if q is close enough to point _p on z=0 plane, update q's z-value
-      if (norm(q - p) < 0.05) U(i, j) = 0.2;
+      if (sqrnorm(q - p) < radius * radius) U(i, j) = 0.2;
     }
   }
 
-  // recompute grid normals
-  update_normals();
+  // in 3D the brush is a ball around p on the shown slice
+  if (volume_mode_)
+  {
+    const int r = int(radius * s);
+    const int k0 = std::max(volume_slice_ - r, 0);
+    const int k1 = std::min(volume_slice_ + r + 1, n);
+    for (int k = k0; k < k1; ++k)
+    {
+      const float dz = float(k - volume_slice_) / s;
+      for (int i = i0; i < i1; ++i)
+      {
+        for (int j = j0; j < j1; ++j)
+        {
+          vec3 q(X(i, j), Y(i, j), dz);
+          if (sqrnorm(q - p) < radius * radius) volume_(i, j, k) = 0.2;
+        }
+      }
+    }
+  }
+
+  // the quadtree takes the new values at the finest level
+  if (integrator_ == ADAPTIVE && !amr_.empty())
+  {
+    amr_.load(field_, i0, j0, i1, j1);
+    amr_.lattice_lines(amr_lines_);
+  }
+
+  // recompute the brush rectangle with the next frame
+  mark_dirty(i0, j0, i1, j1);
 }
 
 //-----------------------------------------------------------------------------
@@ -479,6 +934,9 @@ void HeatEquationViewer::display()
   glClearColor(1.0, 1.0, 1.0, 1.0);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+  // bring the mesh up to date with the simulation, once per frame at most
+  if (!dirty_rects_.empty()) update_mesh();
+
   // adjust viewport
   glViewport(0, 0, m_width, m_height);
 
@@ -507,8 +965,18 @@ void HeatEquationViewer::display()
   glDisable(GL_TEXTURE_1D);
   glDepthRange(0.0, 1.0);
 
+  // draw the lattices of the quadtree blocks instead of the grid edges
+  if (render_wireframe_ && !amr_lines_.empty())
+  {
+    glColor3f(0, 0, 0);
+    glDisable(GL_LIGHTING);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, amr_lines_.data());
+    glDrawArrays(GL_LINES, 0, amr_lines_.size() / 3);
+  }
+
   // draw grid edges
-  if (render_wireframe_)
+  else if (render_wireframe_)
   {
     glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
     glColor3f(0, 0, 0);
@@ -529,48 +997,189 @@ void HeatEquationViewer::display()
 void HeatEquationViewer::explicit_euler_step()
 {
   /**
-   * \todo Update the height values `U(i, j)` at every grid point `(i, j)` by
-   * an explicit integration (Euler) of the heat equation.
-   *
-   * The grid `U` and `V` that contain the height values and the velocities,
-   * respectively, already exist. Just take care of the following two steps:
-   * 1. Compute the time-derivative of `U(i, j)` and store the value in
-   *    the velocity field `V(i, j)` at every point `(i, j)`.
-   * 2. Update `U(i, j)` in the direction `V(i, j)` for every point `(i, j)`.
+   * Explicit (Euler) integration of the heat equation with grid spacing `2`,
+   * boundary points stay fixed. The time derivative of `U(i, j)` is not
+   * stored separately: HeatField evaluates the 5-point Laplacian and the
+   * update in a single branch-free sweep over its padded rows, writing into
+   * a back buffer that is swapped afterwards. The loop has no aliasing and
+   * no conditionals, so the compiler vectorizes it.
    *
-   * Hints:
-   * - `time_step_` is the time step, required for updating `U`.
-   * - `grid_resolution_` is the grid resolution, i.e. both `i` and `j` run
-   *   from `0` to `grid_resolution - 1`. Points at the boundary should stay
-   * fixed.
-   * - Consider the grid spacing to be `2`.
+   * For several steps per frame, up to `field_.block_depth()` steps are
+   * fused into one pass over memory, see HeatField::explicit_euler_steps().
    */
 
-  float h = 2.0 * 2.0;
-  int i, j;
+  field_.explicit_euler_steps(time_step_, steps_per_frame_);
+}
+
+//-----------------------------------------------------------------------------
 
-  for (i = 1; i < grid_resolution_ - 1; i++)
+void HeatEquationViewer::implicit_step()
+{
+  // no global factorization, only independent tridiagonal solves
+  if (integrator_ == ADI)
   {
-    for (j = 1; j < grid_resolution_ - 1; j++)
-    {
-      V(i, j) = (U(i - 1, j) + U(i + 1, j) + U(i, j - 1) + U(i, j + 1) -
-                 4 * U(i, j)) /
-                h;
-    }
+    adi_.step(field_, time_step_, steps_per_frame_);
+    return;
   }
 
-  for (i = 1; i < grid_resolution_ - 1; i++)
+  if (grid_resolution_ > MAX_IMPLICIT_RESOLUTION)
   {
-    for (j = 1; j < grid_resolution_ - 1; j++)
-    {
-      U(i, j) += time_step_ * V(i, j);
-    }
+    std::cerr << "Implicit Euler and Crank-Nicolson are limited to "
+              << MAX_IMPLICIT_RESOLUTION << "x" << MAX_IMPLICIT_RESOLUTION
+              << " grids, use ADI\n";
+    animate_ = false;
+    return;
+  }
+
+  // the factorization is reused until the resolution or time step changes.
+  // A failed one would be retried every frame, so the animation stops.
+  if (!implicit_.step(field_, time_step_,
+                      integrator_ == CRANK_NICOLSON
+                          ? ImplicitIntegrator::CRANK_NICOLSON
+                          : ImplicitIntegrator::IMPLICIT_EULER,
+                      steps_per_frame_))
+  {
+    std::cerr << "Implicit time step failed, animation stopped\n";
+    animate_ = false;
   }
 }
 
 //-----------------------------------------------------------------------------
 
+void HeatEquationViewer::super_time_step()
+{
+  // the number of stages follows from the time step, about sqrt(4 dt)
+  // stencil sweeps instead of dt explicit Euler steps. The stages are kept
+  // in three extra copies of the field.
+  if (RKL_Integrator::bytes(grid_resolution_) > MAX_RKL_BYTES)
+  {
+    std::cerr << "RKL2: the stages of a " << grid_resolution_ << " x "
+              << grid_resolution_ << " grid need too much memory, use a"
+                 " smaller grid\n";
+    animate_ = false;
+    return;
+  }
+
+  rkl_.step(field_, time_step_, steps_per_frame_);
+}
+
+//-----------------------------------------------------------------------------
+
+void HeatEquationViewer::exponential_step()
+{
+  // all steps of the frame are one step of size steps_per_frame_ * dt, at
+  // the cost of three 2D sine transforms. The transform is fastest when
+  // N-1 is a power of two (e.g. 1025 or 4097).
+  spectral_.step(field_, time_step_, steps_per_frame_);
+}
+
+//-----------------------------------------------------------------------------
+
+void HeatEquationViewer::parareal_step()
+{
+  // the steps of a frame are cut into time slices that are integrated in
+  // parallel, and corrected by a serial sweep of large implicit steps
+  // until they agree with serial time stepping. Each slice keeps copies of
+  // the field.
+  if (parareal_.bytes(grid_resolution_, steps_per_frame_) >
+      MAX_PARAREAL_BYTES)
+  {
+    std::cerr << "Parareal: a " << grid_resolution_ << " x "
+              << grid_resolution_ << " grid with "
+              << std::min(parareal_.slices(), steps_per_frame_)
+              << " time slices needs too much memory, use fewer slices or"
+                 " a smaller grid\n";
+    animate_ = false;
+    return;
+  }
+
+  parareal_.step(field_, time_step_, steps_per_frame_);
+}
+
+//-----------------------------------------------------------------------------
+
+void HeatEquationViewer::adaptive_step()
+{
+  // the quadtree is built from field_ when the integrator is selected (or
+  // field_ has been changed otherwise), and only then. Time steps only
+  // update the blocks, and field_ is interpolated from them for display.
+  if (amr_.empty()) amr_.load(field_);
+  amr_.step(time_step_, steps_per_frame_);
+  amr_.store(field_);
+  amr_.lattice_lines(amr_lines_);
+}
+
+//-----------------------------------------------------------------------------
+
+void HeatEquationViewer::clear_adaptive()
+{
+  amr_.clear();
+  amr_lines_.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+void HeatEquationViewer::load_volume()
+{
+  const int n = grid_resolution_;
+  if (n > MAX_VOLUME_RESOLUTION)
+  {
+    std::cerr << "The 3D simulation is limited to " << MAX_VOLUME_RESOLUTION
+              << "^3 grids\n";
+    volume_mode_ = false;
+    return;
+  }
+
+  if (volume_.resolution() != n) volume_.resize(n);
+  volume_slice_ = std::min(volume_slice_, n - 1);
+
+  // the same slabs of planes as in the time steps
+  team_.run([this, n](int _thread) {
+    if (_thread >= n) return;
+    int begin, end;
+    ThreadTeam::band(0, n, std::min(team_.size(), n), _thread, begin, end);
+
+    for (int k = begin; k < end; ++k)
+      for (int i = 0; i < n; ++i)
+        std::copy_n(field_.row(i), n, volume_.row(i, k));
+  });
+}
+
+//-----------------------------------------------------------------------------
+
+void HeatEquationViewer::volume_step()
+{
+  // slabs of planes are streamed tile by tile, see VolumeField
+  volume_.explicit_euler_steps(time_step_, steps_per_frame_);
+  show_slice();
+}
+
+//-----------------------------------------------------------------------------
+
+void HeatEquationViewer::show_slice()
+{
+  const int n = grid_resolution_;
+  for (int i = 0; i < n; ++i)
+    std::copy_n(volume_.row(i, volume_slice_), n, field_.row(i));
+  mark_dirty();
+}
+
+//-----------------------------------------------------------------------------
+
 void HeatEquationViewer::solve_equilibrium()
+{
+  // the equilibrium is only computed in 2D
+  volume_mode_ = false;
+  clear_adaptive();
+  if (equilibrium_solver_ == MULTIGRID)
+    solve_multigrid();
+  else
+    solve_band_cholesky();
+}
+
+//-----------------------------------------------------------------------------
+
+void HeatEquationViewer::solve_band_cholesky()
 {
   Timer timer;
   timer.start();
@@ -582,7 +1191,8 @@ void HeatEquationViewer::solve_equilibrium()
    *
    * 1. Setup the linear system `A * x = b` for the Laplace equation.
    * 2. Since the system is symmetric positive definite, use a Cholesky
-   * solver, provided by Eigen, to solve it.
+   * solver to solve it. The matrix is a band matrix, so a band Cholesky
+   * solver only needs memory and time for the band.
    *
    * Hints:
    * - Again, boundary points stay fixed, so the matrix `A` is
@@ -606,64 +1216,126 @@ void HeatEquationViewer::solve_equilibrium()
   // Define dimension (n x n) of matrix A
   int m = (r - 2) * (r - 2);
 
-  // Declare the vectors x and b, initialize b with 0
-  VectorX x(m), b(m);
-  b.setZero();
+  // A only depends on the resolution (and on the discretization, the
+  // 5-point Laplacian, version 1 in the upper bits), so its factorization
+  // is reused for all boundary values.
+  const uint64_t key = (uint64_t(1) << 32) | uint64_t(r);
+  const BandCholeskySolver* solver = factorizations_.find(key);
+  const bool cached = (solver != nullptr);
 
-  // Declare matrix A by its dimensions and initialize it with 0
-  MatrixXX A(m, m);
-  A = MatrixXX::Zero(m, m);
-
-  for (i = 1; i < r - 1; i++)
+  if (!cached)
   {
-    for (j = 1; j < r - 1; j++)
+    // A couples each point to its neighbors in the rows above and below, at
+    // a distance of r-2 in the numbering, so its bandwidth is r-2. Only the
+    // lower band is stored.
+    const int bandwidth = r - 2;
+    if (BandCholeskySolver::bytes(m, bandwidth) > MAX_EQUILIBRIUM_BYTES)
     {
-      // k       = IDX(i, j);  // k = idx(i, j)
-      // b(k)    = 0.0;
+      std::cerr << "Equilibrium: a " << r << " x " << r
+                << " grid needs too much memory for the band matrix\n";
+      return;
+    }
 
-      int idx = IDX(i, j);
-      A(idx, idx) = 4.0;
+    // Declare matrix A by its dimensions and initialize it with 0
+    std::unique_ptr<BandCholeskySolver> A(new BandCholeskySolver);
+    A->resize(m, bandwidth);
 
-      // left neighbour
-      if (i > 1)
-        A(idx, IDX(i - 1, j)) = -1.0;
-      else
-        b(idx) -= -1.0  * U(i - 1, j);
+    for (i = 1; i < r - 1; i++)
+    {
+      for (j = 1; j < r - 1; j++)
+      {
+        int idx = IDX(i, j);
+        (*A)(idx, idx) = 4.0;
+
+        // left and bottom neighbours, the lower band entries of this row.
+        // The right and top ones are stored in the rows of the neighbours.
+        if (i > 1) (*A)(idx, IDX(i - 1, j)) = -1.0;
+        if (j > 1) (*A)(idx, IDX(i, j - 1)) = -1.0;
+      }
+    }
 
-      // right neighbour
-      if (i < r - 2)
-        A(idx, IDX(i + 1, j)) = -1.0;
-      else
-        b(idx) -= -1.0  * U(i + 1, j);
+    // band Cholesky factorization of A
+    if (!A->factorize())
+    {
+      std::cerr << "Equilibrium: factorization failed\n";
+      return;
+    }
+    solver = factorizations_.insert(key, std::move(A));
+  }
 
-      // bottom neighbour
-      if (j > 1)
-        A(idx, IDX(i, j - 1)) = -1.0;
-      else
-        b(idx) -= -1.0  * U(i, j - 1);
+  // Declare the vectors x and b. Boundary values are moved to b.
+  VectorX x(m), b(m);
+  b.setZero();
 
-      // top neighbour
-      if (j < r - 2)
-        A(idx, IDX(i, j + 1)) = -1.0;
-      else
-        b(idx) -= -1.0  * U(i, j + 1);
+  for (i = 1; i < r - 1; i++)
+  {
+    for (j = 1; j < r - 1; j++)
+    {
+      int idx = IDX(i, j);
+      if (i == 1) b(idx) -= -1.0 * U(i - 1, j);
+      if (i == r - 2) b(idx) -= -1.0 * U(i + 1, j);
+      if (j == 1) b(idx) -= -1.0 * U(i, j - 1);
+      if (j == r - 2) b(idx) -= -1.0 * U(i, j + 1);
     }
   }
 
-  // Use Eigen Cholesky solver to solve "A * x = b"
-  // x = A.llt().solve(b);
-  Eigen::LLT<MatrixXX> solver;
-  solver.compute(A);
-  if (solver.info() == Eigen::Success) x = solver.solve(b);
+  // solve "A * x = b" with the factorization
+  solver->solve(b, x);
 
   for (i = 1; i < r - 1; i++) {
     for (j = 1; j < r - 1; j++) {
       U(i, j) = x(IDX(i, j));
     }
   }
+#undef IDX
+
+  timer.stop();
+  std::cerr << "Cholesky Solve: " << timer
+            << (cached ? " (cached factorization)" : "") << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+
+void HeatEquationViewer::solve_multigrid()
+{
+  Timer timer;
+  timer.start();
+
+  const int r = grid_resolution_;
+  int       i, j;
+
+  if (Multigrid::bytes(r) > MAX_MULTIGRID_BYTES)
+  {
+    std::cerr << "Equilibrium: a " << r << " x " << r
+              << " grid needs too much memory for multigrid\n";
+    return;
+  }
+
+  // the hierarchy only depends on the resolution
+  if (multigrid_.resolution() != r) multigrid_.resize(r);
+
+  // the current field (including the fixed boundary) is the initial guess,
+  // there are no heat sources
+  for (i = 0; i < r; i++)
+  {
+    for (j = 0; j < r; j++)
+    {
+      multigrid_.u(i, j) = U(i, j);
+      multigrid_.f(i, j) = 0.0;
+    }
+  }
+
+  // the number of cycles does not depend on the resolution, so the solve
+  // is linear in the number of grid points
+  const int cycles = multigrid_.solve(1e-10, 50);
+
+  for (i = 1; i < r - 1; i++)
+    for (j = 1; j < r - 1; j++) U(i, j) = multigrid_.u(i, j);
 
   timer.stop();
-  std::cerr << "Cholesky Solve: " << timer << std::endl;
+  std::cerr << "Multigrid Solve: " << timer << " (" << cycles
+            << " V-cycles, residual " << multigrid_.residual() << ")"
+            << std::endl;
 }
 
 //=============================================================================
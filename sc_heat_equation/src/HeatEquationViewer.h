@@ -13,8 +13,20 @@
 #include <pmp/Window.h>
 #include <pmp/MatVec.h>
 
+#include <functional>
 #include <vector>
 #include "types.h"
+#include "adi_integrator.h"
+#include "factorization_cache.h"
+#include "heat_field.h"
+#include "implicit_integrator.h"
+#include "multigrid.h"
+#include "parareal_integrator.h"
+#include "quadtree_field.h"
+#include "rkl_integrator.h"
+#include "spectral_integrator.h"
+#include "thread_team.h"
+#include "volume_field.h"
 
 using namespace pmp;
 
@@ -27,6 +39,54 @@ class HeatEquationViewer : public Window
 {
 public:
 
+    /// memory limit of the band matrices in solve_equilibrium(), also the
+    /// budget of the cached factorizations
+    static const size_t MAX_EQUILIBRIUM_BYTES = size_t(2) << 30;
+
+    /// memory limit of the multigrid hierarchy in solve_equilibrium()
+    static const size_t MAX_MULTIGRID_BYTES = size_t(3) << 30;
+
+    /// largest simulation grid
+    static const int MAX_RESOLUTION = 16384;
+
+    /// The render mesh has at most this many vertices in each direction,
+    /// about the pixel resolution of the window. Larger simulation grids
+    /// are reduced to it, so the render cost does not grow with them.
+    static const int MAX_MESH_RESOLUTION = 1024;
+
+    /// largest grid for implicit Euler and Crank-Nicolson, whose sparse
+    /// factorization grows faster than the grid (ADI has no limit)
+    static const int MAX_IMPLICIT_RESOLUTION = 1024;
+
+    /// memory limit of the time slices of the Parareal integrator
+    static const size_t MAX_PARAREAL_BYTES = size_t(3) << 30;
+
+    /// memory limit of the stage buffers of the RKL2 integrator
+    static const size_t MAX_RKL_BYTES = size_t(3) << 30;
+
+    /// largest grid of the 3D simulation, whose two buffers take 1 GB
+    static const int MAX_VOLUME_RESOLUTION = 512;
+
+    /// time integration methods
+    enum Integrator
+    {
+        EXPLICIT_EULER=0,
+        IMPLICIT_EULER=1,
+        CRANK_NICOLSON=2,
+        ADI=3,
+        RKL2=4,
+        EXPONENTIAL=5,
+        PARAREAL=6,
+        ADAPTIVE=7
+    };
+
+    /// solvers for the equilibrium
+    enum EquilibriumSolver
+    {
+        BAND_CHOLESKY=0,
+        MULTIGRID=1
+    };
+
     /// constructor
     HeatEquationViewer(const char* _title, int _width, int _height);
 
@@ -61,55 +121,140 @@ protected:
     /// initialize OpenGL stuff
     void init();
 
-    /// generate a NxN grid
+    /// generate a NxN grid, and a render mesh of at most
+    /// MAX_MESH_RESOLUTION^2 vertices
     void generate_grid(int _resolution);
 
-    /// update the normal vectors of the grid vertices.
-    /// this function has to be called after modifying the grid values.
-    void update_normals();
+    /// rectangle of grid points (or mesh vertices), rows [i0, i1) and
+    /// columns [j0, j1)
+    struct GridRect
+    {
+        int i0, j0, i1, j1;
+    };
+
+    /// set every field value U(i,j) to _f(X(i,j), Y(i,j))
+    void set_field(const std::function<double(double _x, double _y)>& _f);
+
+    /// mark the whole grid as modified, the render mesh is updated when the
+    /// next frame is drawn
+    void mark_dirty();
+
+    /// mark the rectangle [_i0, _i1) x [_j0, _j1) of the grid as modified
+    void mark_dirty(int _i0, int _j0, int _i1, int _j1);
+
+    /// the mesh vertices whose blocks cover the grid points of _rect
+    GridRect mesh_rect(const GridRect& _rect) const;
 
-    /// read-write access grid points
-    vec3& grid_point(int i, int j) { return grid_points_[i*grid_resolution_+j]; }
+    /// update the heights of mesh vertices (_a, _b0..._b1-1) from their
+    /// blocks of field values
+    void update_heights(int _a, int _b0, int _b1);
 
-    /// read-write access normal vectors of grid points
-    vec3& grid_normal(int i, int j) { return grid_normals_[i*grid_resolution_+j]; }
+    /// update the normal vectors of mesh vertices (_a, _b0..._b1-1) from
+    /// the mesh heights
+    void update_normals(int _a, int _b0, int _b1);
+
+    /// update the heights of the render mesh covering the dirty rectangles
+    /// and the normals around them. Called by display(), so the mesh is
+    /// updated at most once per frame.
+    void update_mesh();
+
+    /// read-write access to the vertex (a,b) of the render mesh
+    vec3& grid_point(int a, int b) { return grid_points_[a*mesh_resolution_+b]; }
+
+    /// read-write access to the normal vector of mesh vertex (a,b)
+    vec3& grid_normal(int a, int b) { return grid_normals_[a*mesh_resolution_+b]; }
 
     /// do one step of time integration using one of the below methods
     void time_integration();
 
     /// read-only access to x-coordinate of grid point (i,j)
-    const float X(int i, int j) { return grid_points_[i*grid_resolution_+j][0]; }
+    const float X(int i, int j) { return float(i) / (grid_resolution_ - 1); }
 
     /// read-only access to y-coordinate of grid point (i,j)
-    const float Y(int i, int j) { return grid_points_[i*grid_resolution_+j][1]; }
+    const float Y(int i, int j) { return float(j) / (grid_resolution_ - 1); }
 
-    /// read-write access to z-coordinate of grid point (i,j)
-    float& U(int i, int j) { return grid_points_[i*grid_resolution_+j][2]; }
+    /// read-write access to the field value at grid point (i,j). Call
+    /// mark_dirty() after modifying it, to update the rendered mesh.
+    float& U(int i, int j) { return field_(i, j); }
 
-    /// read-write access to velocities of grid vertex (i,j)
-    float& V(int i, int j) { return grid_velocities_[i*grid_resolution_+j]; }
+    /// explicit Euler integration, steps_per_frame_ steps
+    void explicit_euler_step();
 
-    /// read-write access to acceleration of grid vertex (i,j)
-    float& A(int i, int j) { return grid_accelerations_[i*grid_resolution_+j]; }
+    /// implicit Euler, Crank-Nicolson or ADI integration, steps_per_frame_
+    /// steps
+    void implicit_step();
 
-    /// explicit Euler integration
-    void explicit_euler_step();
+    /// Runge-Kutta-Legendre super-time-stepping, steps_per_frame_ steps
+    void super_time_step();
 
-    /// solve for equilibrium
+    /// exact integration over steps_per_frame_ time steps at once, by the
+    /// sine transform of the field
+    void exponential_step();
+
+    /// steps_per_frame_ explicit Euler steps, parallel in time
+    void parareal_step();
+
+    /// steps_per_frame_ explicit Euler steps on the adaptive quadtree
+    void adaptive_step();
+
+    /// drop the quadtree, e.g. after field_ has been changed
+    void clear_adaptive();
+
+    /// set every plane of volume_ to field_. Leaves the volume mode if the
+    /// grid is larger than MAX_VOLUME_RESOLUTION.
+    void load_volume();
+
+    /// steps_per_frame_ explicit Euler steps of the 3D field
+    void volume_step();
+
+    /// copy plane volume_slice_ of volume_ to field_, for display
+    void show_slice();
+
+    /// solve for equilibrium with equilibrium_solver_
     void solve_equilibrium();
 
+    /// equilibrium by a band Cholesky factorization, which is cached for
+    /// each resolution in memory and in a per-user cache directory (see
+    /// factor_directory() in HeatEquationViewer.cpp)
+    void solve_band_cholesky();
+
+    /// equilibrium by multigrid V-cycles, starting from the current field
+    void solve_multigrid();
+
 protected:
 
-    /// grid resolution
+    /// grid resolution, of the simulation
     int grid_resolution_;
 
-    /// grid data
+    /// resolution of the render mesh, at most MAX_MESH_RESOLUTION
+    int mesh_resolution_;
+
+    /// render mesh data
     std::vector<vec3>   grid_points_;
     std::vector<vec3>   grid_normals_;
     std::vector<GLuint> grid_indices_;
 
-    /// dynamic data for grid vertices
-    std::vector<float>  grid_velocities_, grid_accelerations_;
+    /// mesh vertex a represents the block of grid rows (and columns)
+    /// [mesh_blocks_[a], mesh_blocks_[a+1])
+    std::vector<int> mesh_blocks_;
+
+    /// heights of the mesh vertices, row by row
+    std::vector<float> mesh_heights_;
+
+    /// resolution chosen in the GUI, applied when the slider is released
+    float requested_resolution_;
+
+    /// persistent threads for time stepping and mesh updates
+    ThreadTeam team_;
+
+    /// simulation state, the z-coordinates of grid_points_ follow it
+    HeatField field_;
+
+    /// at most this many dirty rectangles are kept, more are merged
+    static const int MAX_DIRTY_RECTS = 8;
+
+    /// parts of the grid where the render mesh may differ from field_
+    std::vector<GridRect> dirty_rects_;
 
     /// render setting
     bool render_wireframe_;
@@ -126,6 +271,47 @@ protected:
     /// value of time-step
     float time_step_;
 
+    /// number of time steps per frame
+    int steps_per_frame_;
+
+    /// time integration method
+    Integrator integrator_;
+
+    /// implicit integrators, with the factorization of the last time step
+    ImplicitIntegrator implicit_;
+
+    /// alternating-direction implicit integrator
+    ADI_Integrator adi_;
+
+    /// explicit super-time-stepping integrator
+    RKL_Integrator rkl_;
+
+    /// exponential integrator, exact for any time step
+    SpectralIntegrator spectral_;
+
+    /// explicit Euler steps, parallel over time slices
+    PararealIntegrator parareal_;
+
+    /// adaptive explicit Euler, loaded from field_ when it is selected
+    QuadtreeField amr_;
+
+    /// lattice lines of the quadtree blocks, for the wireframe
+    std::vector<float> amr_lines_;
+
+    /// 3D simulation, field_ shows one of its planes
+    VolumeField volume_;
+    bool        volume_mode_;
+    int         volume_slice_;
+
+    /// solver used by solve_equilibrium()
+    EquilibriumSolver equilibrium_solver_;
+
+    /// band Cholesky factorizations of the equilibrium, by resolution
+    FactorizationCache factorizations_;
+
+    /// multigrid hierarchy, kept as long as the resolution does not change
+    Multigrid multigrid_;
+
     /// time counter
     float integration_time_;
 
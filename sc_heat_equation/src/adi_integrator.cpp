@@ -0,0 +1,260 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "adi_integrator.h"
+
+#include <algorithm>
+#include <cstring>
+
+//== IMPLEMENTATION ==========================================================
+
+ADI_Integrator::ADI_Integrator(ThreadTeam* _team)
+    : team_(_team), resolution_(0), r_(0.0f), e_(0.0f)
+{
+  scratch_.resize(team_ ? team_->size() : 1);
+}
+
+//-----------------------------------------------------------------------------
+
+void ADI_Integrator::setup(int _resolution, float _r)
+{
+  if (_resolution == resolution_ && _r == r_) return;
+
+  resolution_ = _resolution;
+  r_          = _r;
+
+  // every system is tridiag(-r, 1+2r, -r) of size N-2
+  const int m = _resolution - 2;
+  upper_.resize(m);
+  inverse_pivot_.resize(m);
+
+  double c = 0.0;
+  for (int k = 0; k < m; ++k)
+  {
+    const double pivot = 1.0 + 2.0 * r_ - (k > 0 ? -r_ * c : 0.0);
+    c                  = -r_ / pivot;
+    upper_[k]          = c;
+    inverse_pivot_[k]  = 1.0 / pivot;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void ADI_Integrator::copy_boundary(HeatField& _field) const
+{
+  const int n     = _field.resolution();
+  const int bytes = (n + 2) * sizeof(float);
+
+  for (int i = -1; i <= n; ++i)
+  {
+    const float* in  = _field.row(i);
+    float*       out = _field.back_row(i);
+
+    if (i < 1 || i > n - 2)
+    {
+      memcpy(out - 1, in - 1, bytes);
+    }
+    else
+    {
+      out[-1]    = in[-1];
+      out[0]     = in[0];
+      out[n - 1] = in[n - 1];
+      out[n]     = in[n];
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void ADI_Integrator::row_half_step(HeatField& _field, int _thread,
+                                   int _n_threads)
+{
+  const int   n = _field.resolution();
+  const int   m = n - 2;
+  const float r = r_, e = e_;
+
+  const float* HEAT_RESTRICT upper = upper_.data();
+  const float* HEAT_RESTRICT pivot = inverse_pivot_.data();
+
+  // LANES rows of right hand side, followed by their interleaved copy
+  std::vector<float>& scratch = scratch_[_thread];
+  scratch.resize(size_t(m) * LANES * 2);
+  float* HEAT_RESTRICT d = scratch.data();
+  float* HEAT_RESTRICT s = d + size_t(m) * LANES;
+
+  // strips of LANES interior rows
+  const int n_strips = (m + LANES - 1) / LANES;
+  int       first, last;
+  ThreadTeam::band(0, n_strips, _n_threads, _thread, first, last);
+
+  for (int strip = first; strip < last; ++strip)
+  {
+    const int i0    = 1 + strip * LANES;
+    const int lanes = std::min(LANES, n - 1 - i0);
+
+    // right hand side (I + dt/2 Ly) u of each row, explicit along the
+    // columns (just u for the implicit splitting). Unused lanes of the
+    // last strip solve a zero system.
+    for (int l = 0; l < LANES; ++l)
+    {
+      float* HEAT_RESTRICT rhs = d + size_t(l) * m;
+
+      if (l >= lanes)
+      {
+        std::fill(rhs, rhs + m, 0.0f);
+        continue;
+      }
+
+      const float* HEAT_RESTRICT up   = _field.row(i0 + l - 1) + 1;
+      const float* HEAT_RESTRICT mid  = _field.row(i0 + l) + 1;
+      const float* HEAT_RESTRICT down = _field.row(i0 + l + 1) + 1;
+
+      for (int k = 0; k < m; ++k)
+        rhs[k] = mid[k] + e * ((up[k] + down[k]) - 2.0f * mid[k]);
+
+      // fixed boundary columns of the implicit part
+      rhs[0] += r * mid[-1];
+      rhs[m - 1] += r * mid[m];
+    }
+
+    // interleave, s[k*LANES + l] is column k+1 of row i0+l. Going through
+    // LANES x LANES blocks keeps both sides in L1.
+    for (int k0 = 0; k0 < m; k0 += LANES)
+    {
+      const int kn = std::min(LANES, m - k0);
+      for (int l = 0; l < LANES; ++l)
+        for (int k = 0; k < kn; ++k)
+          s[(k0 + k) * LANES + l] = d[size_t(l) * m + k0 + k];
+    }
+
+    // Thomas algorithm on all lanes at once: forward elimination...
+    for (int l = 0; l < LANES; ++l) s[l] *= pivot[0];
+    for (int k = 1; k < m; ++k)
+    {
+      float* HEAT_RESTRICT       cur  = s + k * LANES;
+      const float* HEAT_RESTRICT prev = s + (k - 1) * LANES;
+      const float                p    = pivot[k];
+      for (int l = 0; l < LANES; ++l) cur[l] = (cur[l] + r * prev[l]) * p;
+    }
+
+    // ...and back substitution
+    for (int k = m - 2; k >= 0; --k)
+    {
+      float* HEAT_RESTRICT       cur  = s + k * LANES;
+      const float* HEAT_RESTRICT next = s + (k + 1) * LANES;
+      const float                c    = upper[k];
+      for (int l = 0; l < LANES; ++l) cur[l] -= c * next[l];
+    }
+
+    // de-interleave into the back buffer, again blockwise
+    for (int k0 = 0; k0 < m; k0 += LANES)
+    {
+      const int kn = std::min(LANES, m - k0);
+      for (int l = 0; l < lanes; ++l)
+      {
+        float* HEAT_RESTRICT out = _field.back_row(i0 + l) + 1 + k0;
+        for (int k = 0; k < kn; ++k) out[k] = s[(k0 + k) * LANES + l];
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void ADI_Integrator::column_half_step(HeatField& _field, int _thread,
+                                      int _n_threads) const
+{
+  const int   n = _field.resolution();
+  const float r = r_, e = e_;
+
+  // each thread sweeps a band of columns. Full rows of the band stream
+  // through memory much better than narrow blocks that would stay cached.
+  int j0, j1;
+  ThreadTeam::band(1, n - 1, _n_threads, _thread, j0, j1);
+  const int width = j1 - j0;
+  if (width == 0) return;
+
+  // forward elimination down the columns, with the right hand side
+  // (I + dt/2 Lx) u*, explicit along the rows, computed on the fly. The
+  // eliminated values are stored in the back buffer.
+  for (int i = 1; i < n - 1; ++i)
+  {
+    const float* HEAT_RESTRICT mid  = _field.row(i) + j0;
+    const float* HEAT_RESTRICT prev = _field.back_row(i - 1) + j0;
+    float* HEAT_RESTRICT       out  = _field.back_row(i) + j0;
+    const float                p    = inverse_pivot_[i - 1];
+
+    // for i == 1 the previous row is the fixed boundary, which is exactly
+    // its contribution to the right hand side
+    for (int j = 0; j < width; ++j)
+      out[j] = (mid[j] + e * ((mid[j - 1] + mid[j + 1]) - 2.0f * mid[j]) +
+                r * prev[j]) *
+               p;
+
+    // the last row adds the fixed boundary below
+    if (i == n - 2)
+    {
+      const float* HEAT_RESTRICT below = _field.row(n - 1) + j0;
+      for (int j = 0; j < width; ++j) out[j] += r * below[j] * p;
+    }
+  }
+
+  // back substitution up the columns
+  for (int i = n - 3; i >= 1; --i)
+  {
+    const float* HEAT_RESTRICT next = _field.back_row(i + 1) + j0;
+    float* HEAT_RESTRICT       out  = _field.back_row(i) + j0;
+    const float                c    = upper_[i - 1];
+    for (int j = 0; j < width; ++j) out[j] -= c * next[j];
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void ADI_Integrator::step(HeatField& _field, float _time_step, int _n_steps,
+                          Method _method)
+{
+  const int n = _field.resolution();
+  if (n < 3) return;
+
+  if (_method == PEACEMAN_RACHFORD)
+  {
+    setup(n, 0.5f * _time_step / 4.0f);
+    e_ = r_;
+  }
+  else
+  {
+    setup(n, _time_step / 4.0f);
+    e_ = 0.0f;
+  }
+
+  const int n_threads = team_ ? team_->size() : 1;
+
+  for (int s = 0; s < _n_steps; ++s)
+  {
+    // u -> u*
+    copy_boundary(_field);
+    if (n_threads > 1)
+      team_->run([&](int _t) { row_half_step(_field, _t, n_threads); });
+    else
+      row_half_step(_field, 0, 1);
+    _field.swap();
+
+    // u* -> u'
+    copy_boundary(_field);
+    if (n_threads > 1)
+      team_->run([&](int _t) { column_half_step(_field, _t, n_threads); });
+    else
+      column_half_step(_field, 0, 1);
+    _field.swap();
+  }
+}
+
+//=============================================================================
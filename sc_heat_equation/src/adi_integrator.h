@@ -0,0 +1,103 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <vector>
+#include "heat_field.h"
+#include "thread_team.h"
+
+//== CLASS DEFINITION =========================================================
+
+/// Alternating-direction implicit (Peaceman-Rachford) time integration of
+/// the heat equation, with the same Laplacian L = Lx + Ly and fixed
+/// boundary values as the explicit Euler step. A step of size dt is split
+/// into two half steps,
+///
+///     (I - dt/2 Lx) u* = (I + dt/2 Ly) u,
+///     (I - dt/2 Ly) u' = (I + dt/2 Lx) u*,
+///
+/// each of which is a set of independent tridiagonal systems, one per row
+/// or column. The scheme is unconditionally stable and second order in
+/// time. For large dt it damps the highest frequencies only weakly (their
+/// factor goes to -1), so the first order splitting
+///
+///     (I - dt Lx) u* = u,
+///     (I - dt Ly) u' = u*,
+///
+/// is also available, which damps them like implicit Euler does, at the
+/// same cost.
+///
+/// All systems share the same constant coefficients, so the elimination
+/// factors of the Thomas algorithm are computed once per (N, dt). The
+/// column systems are solved for all columns at once, vectorized along the
+/// rows. The row systems are solved LANES rows at a time: a strip of rows
+/// is transposed into a scratch buffer, so that the rows are interleaved
+/// and their solves run in the SIMD lanes. Rows and columns are
+/// distributed over the threads of a ThreadTeam.
+class ADI_Integrator
+{
+public:
+
+    /// number of rows that are solved together
+    static const int LANES = 16;
+
+    /// splittings
+    enum Method
+    {
+        PEACEMAN_RACHFORD=0,
+        IMPLICIT_SPLITTING=1
+    };
+
+    /// constructor, the work is split over the threads of _team (if given)
+    explicit ADI_Integrator(ThreadTeam* _team = nullptr);
+
+    /// advance _field by _n_steps steps of size _time_step with _method
+    void step(HeatField& _field, float _time_step, int _n_steps = 1,
+              Method _method = PEACEMAN_RACHFORD);
+
+private:
+
+    /// compute the elimination factors for N=_resolution and the
+    /// off-diagonal -_r
+    void setup(int _resolution, float _r);
+
+    /// copy the fixed boundary values to the back buffer
+    void copy_boundary(HeatField& _field) const;
+
+    /// first half step: implicit along the rows
+    void row_half_step(HeatField& _field, int _thread, int _n_threads);
+
+    /// second half step: implicit along the columns
+    void column_half_step(HeatField& _field, int _thread,
+                          int _n_threads) const;
+
+private:
+
+    ThreadTeam* team_;
+
+    /// factors are valid for this resolution
+    int resolution_;
+
+    /// weight of the implicit part, the off-diagonal is -r_: dt/2 * 1/h^2
+    /// for grid spacing h = 2 (Peaceman-Rachford) or dt * 1/h^2
+    float r_;
+
+    /// weight of the explicit part, r_ for Peaceman-Rachford, otherwise 0
+    float e_;
+
+    /// Thomas algorithm: upper factors c'_k and inverse pivots 1/(b - a c'_k-1)
+    std::vector<float> upper_, inverse_pivot_;
+
+    /// transposed row strips, one per thread
+    std::vector<std::vector<float>> scratch_;
+};
+
+//=============================================================================
@@ -0,0 +1,276 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "band_cholesky.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//== IMPLEMENTATION ==========================================================
+
+static_assert(sizeof(BandCholeskySolver::Header) == 64,
+              "band file header has to be 64 bytes");
+
+namespace {
+
+const char MAGIC[8] = "SCBAND";
+
+} // anonymous namespace
+
+//-----------------------------------------------------------------------------
+
+BandCholeskySolver::BandCholeskySolver()
+    : n_(0),
+      bandwidth_(0),
+      factorized_(false),
+      data_(nullptr),
+      mapping_(nullptr),
+      mapping_bytes_(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+BandCholeskySolver::~BandCholeskySolver() { unmap(); }
+
+//-----------------------------------------------------------------------------
+
+void BandCholeskySolver::resize(int _n, int _bandwidth)
+{
+  unmap();
+
+  n_          = _n;
+  bandwidth_  = std::max(0, std::min(_bandwidth, _n - 1));
+  factorized_ = false;
+  band_.assign(size_t(_n) * (bandwidth_ + 1), 0.0);
+  data_ = band_.data();
+}
+
+//-----------------------------------------------------------------------------
+
+bool BandCholeskySolver::factorize()
+{
+  const int w = bandwidth_ + 1;
+
+  factorized_ = false;
+
+  // right-looking: finish column j, then subtract its outer product from
+  // the following columns of the band. Each update is a contiguous axpy.
+  for (int j = 0; j < n_; ++j)
+  {
+    Scalar* col = &data_[size_t(j) * w];
+
+    if (col[0] <= 0.0) return false;
+    const Scalar d = std::sqrt(col[0]);
+    col[0]         = d;
+
+    const int    m   = std::min(bandwidth_, n_ - 1 - j);
+    const Scalar inv = 1.0 / d;
+    for (int i = 1; i <= m; ++i) col[i] *= inv;
+
+    // A(j+i, j+k) -= L(j+i, j) L(j+k, j) for k <= i <= m
+    for (int k = 1; k <= m; ++k)
+    {
+      Scalar*      target = &data_[size_t(j + k) * w] - k;
+      const Scalar l      = col[k];
+      if (l == 0.0) continue;
+      for (int i = k; i <= m; ++i) target[i] -= col[i] * l;
+    }
+  }
+
+  factorized_ = true;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void BandCholeskySolver::solve(const VectorX& _b, VectorX& _x) const
+{
+  const int w = bandwidth_ + 1;
+
+  if (&_x != &_b) _x = _b;
+
+  // L y = b, column-oriented
+  for (int j = 0; j < n_; ++j)
+  {
+    const Scalar* col = &data_[size_t(j) * w];
+    const Scalar  y   = _x(j) / col[0];
+    _x(j)             = y;
+
+    const int m = std::min(bandwidth_, n_ - 1 - j);
+    for (int i = 1; i <= m; ++i) _x(j + i) -= col[i] * y;
+  }
+
+  // L^T x = y, row-oriented (rows of L^T are the columns of L)
+  for (int j = n_ - 1; j >= 0; --j)
+  {
+    const Scalar* col = &data_[size_t(j) * w];
+    const int     m   = std::min(bandwidth_, n_ - 1 - j);
+
+    Scalar sum = _x(j);
+    for (int i = 1; i <= m; ++i) sum -= col[i] * _x(j + i);
+    _x(j) = sum / col[0];
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+bool BandCholeskySolver::save(const std::string& _filename,
+                              uint64_t _key) const
+{
+  if (!factorized_) return false;
+
+  Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version      = VERSION;
+  header.scalar_bytes = sizeof(Scalar);
+  header.size         = n_;
+  header.bandwidth    = bandwidth_;
+  header.key          = _key;
+
+  const std::string tmp = _filename + ".tmp";
+  {
+    std::ofstream ofs(tmp.c_str(), std::ios::binary | std::ios::trunc);
+    const std::vector<char> padding(DATA_OFFSET - sizeof(header), 0);
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ofs.write(padding.data(), padding.size());
+    ofs.write(reinterpret_cast<const char*>(data_), bytes(n_, bandwidth_));
+    if (!ofs)
+    {
+      std::cerr << "BandCholeskySolver: cannot write " << tmp << std::endl;
+      ofs.close();
+      std::remove(tmp.c_str());
+      return false;
+    }
+  }
+
+#ifdef _WIN32
+  // rename does not replace existing files on Windows
+  std::remove(_filename.c_str());
+#endif
+  if (std::rename(tmp.c_str(), _filename.c_str()) != 0)
+  {
+    std::cerr << "BandCholeskySolver: cannot rename " << tmp << std::endl;
+    std::remove(tmp.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool BandCholeskySolver::load(const std::string& _filename, uint64_t _key)
+{
+  resize(0, 0);
+
+  // map the file copy-on-write
+  void*  data  = nullptr;
+  size_t bytes = 0;
+#ifdef _WIN32
+  HANDLE file = CreateFileA(_filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) return false;
+  LARGE_INTEGER size;
+  GetFileSizeEx(file, &size);
+  bytes = size.QuadPart;
+  HANDLE mapping =
+      bytes ? CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr)
+            : nullptr;
+  data = mapping ? MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0) : nullptr;
+
+  // the view stays valid
+  if (mapping) CloseHandle(mapping);
+  CloseHandle(file);
+#else
+  int fd = ::open(_filename.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    if (errno != ENOENT)
+      std::cerr << "BandCholeskySolver: cannot open " << _filename
+                << std::endl;
+    return false;
+  }
+  struct stat st;
+  fstat(fd, &st);
+  bytes = st.st_size;
+  data  = bytes > 0 ? mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE, fd, 0)
+                   : MAP_FAILED;
+  ::close(fd); // the mapping stays valid
+  if (data == MAP_FAILED) data = nullptr;
+#endif
+  if (!data)
+  {
+    std::cerr << "BandCholeskySolver: cannot map " << _filename << std::endl;
+    return false;
+  }
+
+  mapping_       = static_cast<char*>(data);
+  mapping_bytes_ = bytes;
+
+  // check header and file size
+  const Header& h = *reinterpret_cast<const Header*>(mapping_);
+  if (bytes < DATA_OFFSET || memcmp(h.magic, MAGIC, 8) != 0 ||
+      h.version != VERSION || h.scalar_bytes != sizeof(Scalar) ||
+      h.key != _key || h.bandwidth >= std::max<uint64_t>(h.size, 1) ||
+      bytes < DATA_OFFSET + BandCholeskySolver::bytes(h.size, h.bandwidth))
+  {
+    std::cerr << "BandCholeskySolver: " << _filename
+              << " is outdated or does not match, ignoring it\n";
+    unmap();
+    return false;
+  }
+
+  n_          = h.size;
+  bandwidth_  = h.bandwidth;
+  factorized_ = true;
+  data_       = reinterpret_cast<Scalar*>(mapping_ + DATA_OFFSET);
+  std::vector<Scalar>().swap(band_);
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void BandCholeskySolver::unmap()
+{
+  if (!mapping_) return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(mapping_);
+#else
+  munmap(mapping_, mapping_bytes_);
+#endif
+
+  mapping_       = nullptr;
+  mapping_bytes_ = 0;
+  n_ = bandwidth_ = 0;
+  factorized_     = false;
+  data_           = band_.data();
+}
+
+//=============================================================================
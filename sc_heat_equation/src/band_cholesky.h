@@ -0,0 +1,126 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "types.h"
+
+//== CLASS DEFINITION =========================================================
+
+/// Cholesky solver for symmetric positive definite band matrices.
+///
+/// Only the lower band is stored, column by column: entries A(j..j+w, j)
+/// of column j are contiguous (LAPACK's lower band layout), with w the
+/// bandwidth. The factor L has the same band, so factorize() overwrites
+/// the matrix in place. This takes O(n w) memory and O(n w^2) time,
+/// instead of O(n^2) and O(n^3) for a dense matrix.
+///
+/// The factor can be saved to a file and mapped back into memory later, so
+/// the factorization of a matrix that is used again (e.g. by another run of
+/// the program) does not have to be repeated. Pages of a mapped factor are
+/// read on demand, and modifying it does not change the file.
+class BandCholeskySolver
+{
+public:
+
+    /// file header
+    struct Header
+    {
+        char     magic[8];     ///< "SCBAND" plus terminating zeros
+        uint32_t version;      ///< format version
+        uint32_t scalar_bytes; ///< sizeof(Scalar) the file was written with
+        uint64_t size;         ///< dimension n of the matrix
+        uint64_t bandwidth;    ///< bandwidth of the matrix
+        uint64_t key;          ///< identifies the matrix, given by the user
+        uint8_t  reserved[24];
+    };
+
+    /// file format version
+    static const uint32_t VERSION = 1;
+
+    /// offset of the band in the file, a page boundary
+    static const size_t DATA_OFFSET = 4096;
+
+    /// constructor
+    BandCholeskySolver();
+
+    /// destructor, unmaps the file
+    ~BandCholeskySolver();
+
+    /// set up a zero _n x _n matrix with bandwidth _bandwidth
+    void resize(int _n, int _bandwidth);
+
+    /// bytes needed for an _n x _n matrix with bandwidth _bandwidth
+    static size_t bytes(int _n, int _bandwidth)
+    {
+        return size_t(_n) * (_bandwidth + 1) * sizeof(Scalar);
+    }
+
+    /// dimension of the matrix
+    int size() const { return n_; }
+
+    /// bandwidth of the matrix
+    int bandwidth() const { return bandwidth_; }
+
+    /// read-write access to entry (_i,_j) of the lower band,
+    /// _j <= _i <= _j + bandwidth()
+    Scalar& operator()(int _i, int _j)
+    {
+        return data_[size_t(_j) * (bandwidth_ + 1) + (_i - _j)];
+    }
+
+    /// factorize A = L L^T in place. Returns false if A is not positive
+    /// definite.
+    bool factorize();
+
+    /// does the band hold the factor L?
+    bool is_factorized() const { return factorized_; }
+
+    /// solve A x = b with the factorization, _x may be _b
+    void solve(const VectorX& _b, VectorX& _x) const;
+
+    /// write the factor to _filename, tagged with _key. The file is written
+    /// under a temporary name and then renamed, so other processes never
+    /// see a partial file.
+    bool save(const std::string& _filename, uint64_t _key) const;
+
+    /// map the factor saved in _filename. Fails (quietly if the file does
+    /// not exist) unless the file has the current version and Scalar type
+    /// and is tagged with _key.
+    bool load(const std::string& _filename, uint64_t _key);
+
+private:
+
+    BandCholeskySolver(const BandCholeskySolver&) = delete;
+    BandCholeskySolver& operator=(const BandCholeskySolver&) = delete;
+
+    /// unmap the file, if any
+    void unmap();
+
+private:
+
+    int  n_, bandwidth_;
+    bool factorized_;
+
+    /// lower band, column by column, unless a file is mapped
+    std::vector<Scalar> band_;
+
+    /// the lower band, in band_ or in the mapped file
+    Scalar* data_;
+
+    /// mapped file
+    char*  mapping_;
+    size_t mapping_bytes_;
+};
+
+//=============================================================================
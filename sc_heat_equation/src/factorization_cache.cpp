@@ -0,0 +1,196 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "factorization_cache.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+//== IMPLEMENTATION ==========================================================
+
+FactorizationCache::FactorizationCache(size_t _max_bytes,
+                                       const std::string& _directory)
+    : max_bytes_(_max_bytes),
+      directory_(_directory),
+      directory_created_(false),
+      clock_(0),
+      memory_hits_(0),
+      disk_hits_(0),
+      misses_(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+const BandCholeskySolver* FactorizationCache::find(uint64_t _key)
+{
+  ++clock_;
+
+  for (Entry& e : entries_)
+  {
+    if (e.key == _key)
+    {
+      e.last_use = clock_;
+      ++memory_hits_;
+      return e.solver.get();
+    }
+  }
+
+  if (!directory_.empty())
+  {
+    std::unique_ptr<BandCholeskySolver> solver(new BandCholeskySolver);
+    if (solver->load(filename(_key), _key))
+    {
+      ++disk_hits_;
+      return add(_key, std::move(solver));
+    }
+  }
+
+  ++misses_;
+  return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+
+const BandCholeskySolver* FactorizationCache::insert(
+    uint64_t _key, std::unique_ptr<BandCholeskySolver> _solver)
+{
+  if (!directory_.empty() &&
+      BandCholeskySolver::bytes(_solver->size(), _solver->bandwidth()) >=
+          MIN_FILE_BYTES &&
+      create_directory())
+  {
+    _solver->save(filename(_key), _key);
+  }
+
+  return add(_key, std::move(_solver));
+}
+
+//-----------------------------------------------------------------------------
+
+const BandCholeskySolver* FactorizationCache::add(
+    uint64_t _key, std::unique_ptr<BandCholeskySolver> _solver)
+{
+  const size_t new_bytes =
+      BandCholeskySolver::bytes(_solver->size(), _solver->bandwidth());
+
+  // replace an older factorization for the same key
+  for (size_t k = 0; k < entries_.size(); ++k)
+  {
+    if (entries_[k].key == _key)
+    {
+      entries_.erase(entries_.begin() + k);
+      break;
+    }
+  }
+
+  // evict the least recently used factors until the new one fits. It is
+  // kept even if it alone exceeds the budget.
+  size_t total = bytes();
+  while (!entries_.empty() && total + new_bytes > max_bytes_)
+  {
+    size_t lru = 0;
+    for (size_t k = 1; k < entries_.size(); ++k)
+      if (entries_[k].last_use < entries_[lru].last_use) lru = k;
+
+    total -= BandCholeskySolver::bytes(entries_[lru].solver->size(),
+                                       entries_[lru].solver->bandwidth());
+    entries_.erase(entries_.begin() + lru);
+  }
+
+  Entry e;
+  e.key      = _key;
+  e.solver   = std::move(_solver);
+  e.last_use = clock_;
+  entries_.push_back(std::move(e));
+
+  return entries_.back().solver.get();
+}
+
+//-----------------------------------------------------------------------------
+
+size_t FactorizationCache::bytes() const
+{
+  size_t total = 0;
+  for (const Entry& e : entries_)
+    total += BandCholeskySolver::bytes(e.solver->size(), e.solver->bandwidth());
+  return total;
+}
+
+//-----------------------------------------------------------------------------
+
+std::string FactorizationCache::user_directory(const std::string& _application)
+{
+#ifdef _WIN32
+  const char* base = getenv("LOCALAPPDATA");
+  if (base && *base) return std::string(base) + "/" + _application;
+#else
+  const char* base = getenv("XDG_CACHE_HOME");
+  if (base && *base) return std::string(base) + "/" + _application;
+  const char* home = getenv("HOME");
+  if (home && *home) return std::string(home) + "/.cache/" + _application;
+#endif
+  return "";
+}
+
+//-----------------------------------------------------------------------------
+
+bool FactorizationCache::create_directory()
+{
+  if (directory_created_) return true;
+
+  // create each missing component of the path
+  for (size_t end = 0; end != std::string::npos;)
+  {
+    end = directory_.find_first_of("/\\", end + 1);
+    const std::string path = directory_.substr(0, end);
+#ifdef _WIN32
+    const bool ok = CreateDirectoryA(path.c_str(), nullptr) ||
+                    GetLastError() == ERROR_ALREADY_EXISTS;
+#else
+    struct stat st;
+    const bool ok = mkdir(path.c_str(), 0755) == 0 ||
+                    (stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode));
+#endif
+    if (!ok && end == std::string::npos)
+    {
+      std::cerr << "FactorizationCache: cannot create " << directory_
+                << ", factors are not saved\n";
+      directory_.clear();
+      return false;
+    }
+  }
+
+  std::cout << "FactorizationCache: saving factors of "
+            << (MIN_FILE_BYTES >> 20) << " MB or more in " << directory_
+            << std::endl;
+  directory_created_ = true;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+std::string FactorizationCache::filename(uint64_t _key) const
+{
+  char name[64];
+  snprintf(name, sizeof(name), "factor_%016llx.band",
+           (unsigned long long)_key);
+  return directory_ + "/" + name;
+}
+
+//=============================================================================
@@ -0,0 +1,111 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "band_cholesky.h"
+
+//== CLASS DEFINITION =========================================================
+
+/// Cache of band Cholesky factorizations, for matrices that only depend on
+/// a few parameters (e.g. the grid resolution) and are solved with many
+/// right hand sides.
+///
+/// Factorizations are identified by a 64 bit key, which has to encode
+/// everything the matrix depends on. The cache has two tiers: factors in
+/// memory, evicted least recently used first when they exceed the memory
+/// budget, and factor files in a directory, which are mapped into memory
+/// when a key is not found in memory. So a restarted program reuses the
+/// factorizations of earlier runs. The files are kept until they are
+/// deleted by hand; user_directory() is a place for them that is not
+/// cluttered otherwise.
+class FactorizationCache
+{
+public:
+
+    /// factors smaller than this are not written to disk, refactorizing
+    /// them is cheaper than reading them
+    static const size_t MIN_FILE_BYTES = size_t(1) << 20;
+
+    /// cache of at most _max_bytes in memory. If _directory is not empty,
+    /// factors are also stored in files in this directory, which is created
+    /// when the first file is written.
+    explicit FactorizationCache(size_t _max_bytes,
+                                const std::string& _directory = "");
+
+    /// the factorization for _key, or nullptr if it is neither in memory
+    /// nor on disk
+    const BandCholeskySolver* find(uint64_t _key);
+
+    /// add the factorized _solver for _key, and write it to disk. Returns
+    /// the cached solver.
+    const BandCholeskySolver* insert(uint64_t _key,
+                                     std::unique_ptr<BandCholeskySolver> _solver);
+
+    /// the per-user cache directory of _application: $XDG_CACHE_HOME or
+    /// ~/.cache (%LOCALAPPDATA% on Windows), or "" if neither is known
+    static std::string user_directory(const std::string& _application);
+
+    /// directory of the factor files ("" if none)
+    const std::string& directory() const { return directory_; }
+
+    /// remove all factors from memory (files are kept)
+    void clear() { entries_.clear(); }
+
+    /// bytes of the factors in memory (mapped or not)
+    size_t bytes() const;
+
+    /// hits in memory, hits on disk, and misses so far
+    int memory_hits() const { return memory_hits_; }
+    int disk_hits() const { return disk_hits_; }
+    int misses() const { return misses_; }
+
+private:
+
+    /// one cached factorization
+    struct Entry
+    {
+        uint64_t                            key;
+        std::unique_ptr<BandCholeskySolver> solver;
+        uint64_t                            last_use;
+    };
+
+    /// name of the file for _key
+    std::string filename(uint64_t _key) const;
+
+    /// create directory_ and its parents, if missing. Returns false if it
+    /// cannot be created.
+    bool create_directory();
+
+    /// add an entry, evicting others to make room for it
+    const BandCholeskySolver* add(uint64_t _key,
+                                  std::unique_ptr<BandCholeskySolver> _solver);
+
+private:
+
+    size_t      max_bytes_;
+    std::string directory_;
+
+    /// has directory_ been created (or found)?
+    bool directory_created_;
+
+    std::vector<Entry> entries_;
+
+    /// counts find() calls, for the least recently used eviction
+    uint64_t clock_;
+
+    int memory_hits_, disk_hits_, misses_;
+};
+
+//=============================================================================
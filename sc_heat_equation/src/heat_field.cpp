@@ -0,0 +1,298 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "heat_field.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+//== IMPLEMENTATION ==========================================================
+
+HeatField::HeatField(ThreadTeam* _team)
+    : team_(_team),
+      resolution_(0),
+      pitch_(0),
+      block_depth_(1),
+      current_(nullptr),
+      next_(nullptr)
+{
+  if (team_) progress_.reset(new Progress[team_->size()]);
+  scratch_.resize(team_ ? team_->size() : 1);
+}
+
+//-----------------------------------------------------------------------------
+
+void HeatField::resize(int _resolution)
+{
+  resolution_ = _resolution;
+
+  // one line of padding in front of each row (holding the ghost column -1),
+  // the row itself, and the ghost column N
+  const int line = FLOATS_PER_LINE;
+  pitch_         = (line + _resolution + 1 + line - 1) / line * line;
+
+  // two buffers of N+2 rows each, plus slack for the alignment. The memory
+  // is not initialized here, but by the thread that owns the rows.
+  const size_t buffer_size = size_t(_resolution + 2) * pitch_;
+  storage_.reset(new float[2 * buffer_size + line]);
+
+  float* base = storage_.get();
+  while (reinterpret_cast<uintptr_t>(base) % ALIGNMENT) ++base;
+  current_ = base;
+  next_    = base + buffer_size;
+
+  // rows -1..N, including their padding, tile the buffers exactly. Each
+  // thread clears the rows it will update in explicit_euler_steps().
+  const int n_bands = team_ ? std::min(team_->size(), _resolution + 2) : 1;
+  auto      clear   = [&](int _thread) {
+    if (_thread >= n_bands) return;
+    int begin, end;
+    ThreadTeam::band(-1, _resolution + 1, n_bands, _thread, begin, end);
+    const size_t offset = size_t(begin + 1) * pitch_;
+    const size_t bytes  = size_t(end - begin) * pitch_ * sizeof(float);
+    memset(current_ + offset, 0, bytes);
+    memset(next_ + offset, 0, bytes);
+  };
+
+  if (n_bands > 1)
+    team_->run(clear);
+  else
+    clear(0);
+}
+
+//-----------------------------------------------------------------------------
+
+void HeatField::copy_boundary(const float* _in, float* _out, int _begin,
+                              int _end) const
+{
+  const int n = resolution_;
+
+  for (int i = _begin; i < _end; ++i)
+  {
+    // the boundary rows (and the ghost rows next to them) stay fixed: copy
+    // them including their padding
+    if (i < 1 || i > n - 2)
+    {
+      memcpy(_out + index(i, -FLOATS_PER_LINE),
+             _in + index(i, -FLOATS_PER_LINE), pitch_ * sizeof(float));
+    }
+    else
+    {
+      const float* in  = _in + index(i, 0);
+      float*       out = _out + index(i, 0);
+      out[-1]          = in[-1];
+      out[0]           = in[0];
+      out[n - 1]       = in[n - 1];
+      out[n]           = in[n];
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+/// one step for _count consecutive values of a row, given the rows above
+/// and below. The loop is branch-free and vectorized by the compiler.
+static inline void euler_kernel(const float* HEAT_RESTRICT _up,
+                                const float* HEAT_RESTRICT _mid,
+                                const float* HEAT_RESTRICT _down,
+                                float* HEAT_RESTRICT _out, int _count,
+                                float _c, float _d)
+{
+  for (int j = 0; j < _count; ++j)
+    _out[j] = _d * _mid[j] +
+              _c * ((_up[j] + _down[j]) + (_mid[j - 1] + _mid[j + 1]));
+}
+
+//-----------------------------------------------------------------------------
+
+void HeatField::euler_rows(const float* _in, float* _out, int _begin,
+                           int _end, float _time_step) const
+{
+  // U += dt * (U(i-1,j) + U(i+1,j) + U(i,j-1) + U(i,j+1) - 4 U(i,j)) / h,
+  // with h = 2*2, rearranged to one multiply-add per neighbor sum
+  const int   n = resolution_;
+  const float c = _time_step / 4.0f;
+  const float d = 1.0f - 4.0f * c;
+
+  copy_boundary(_in, _out, _begin, _end);
+
+  for (int i = std::max(_begin, 1); i < std::min(_end, n - 1); ++i)
+    euler_kernel(_in + index(i - 1, 1), _in + index(i, 1),
+                 _in + index(i + 1, 1), _out + index(i, 1), n - 2, c, d);
+}
+
+//-----------------------------------------------------------------------------
+
+void HeatField::euler_tile(const float* _in, float* _out, int _i0, int _i1,
+                           int _j0, int _j1, int _depth, float _time_step,
+                           std::vector<float>& _scratch) const
+{
+  const int   n = resolution_;
+  const int   k = _depth;
+  const float c = _time_step / 4.0f;
+  const float d = 1.0f - 4.0f * c;
+
+  // step t (0: input) is needed on [_i0 - (k-t), _i1 + (k-t)) x
+  // [_j0 - (k-t), _j1 + (k-t)), clipped to the grid
+  auto lo = [&](int _a, int _t) { return std::max(0, _a - (k - _t)); };
+  auto hi = [&](int _b, int _t) { return std::min(n, _b + (k - _t)); };
+
+  // steps 1..k-1 keep their last three rows in a ring buffer
+  const int base   = lo(_j0, 0);
+  const int stride = (hi(_j1, 0) - base + FLOATS_PER_LINE - 1) /
+                     FLOATS_PER_LINE * FLOATS_PER_LINE;
+  _scratch.resize(size_t(3) * (k - 1) * stride);
+
+  // value (i,j) of step t
+  auto at = [&](int _t, int _i, int _j) -> float* {
+    if (_t == 0) return const_cast<float*>(_in) + index(_i, _j);
+    if (_t == k) return _out + index(_i, _j);
+    return _scratch.data() + size_t(3 * (_t - 1) + _i % 3) * stride +
+           (_j - base);
+  };
+
+  // wavefront: row i of step t is computed in front i + t-1, after row i+1
+  // of step t-1
+  for (int f = lo(_i0, 1); f < _i1 + k - 1; ++f)
+  {
+    for (int t = 1; t <= k; ++t)
+    {
+      const int i = f - (t - 1);
+      if (i < lo(_i0, t) || i >= hi(_i1, t)) continue;
+
+      int a = lo(_j0, t), b = hi(_j1, t);
+
+      // boundary rows and columns keep their values
+      if (i == 0 || i == n - 1)
+      {
+        memcpy(at(t, i, a), at(0, i, a), (b - a) * sizeof(float));
+        continue;
+      }
+      if (a == 0) *at(t, i, a++) = *at(0, i, 0);
+      if (b == n) *at(t, i, --b) = *at(0, i, n - 1);
+
+      euler_kernel(at(t - 1, i - 1, a), at(t - 1, i, a), at(t - 1, i + 1, a),
+                   at(t, i, a), b - a, c, d);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void HeatField::explicit_euler_steps(float _time_step, int _n_steps)
+{
+  if (resolution_ < 3) return;
+
+  if (block_depth_ == 1)
+  {
+    sweep_euler_steps(_time_step, _n_steps);
+    return;
+  }
+
+  for (int s = 0; s < _n_steps; s += block_depth_)
+  {
+    const int depth = std::min(block_depth_, _n_steps - s);
+    if (depth == 1)
+      sweep_euler_steps(_time_step, 1);
+    else
+      blocked_euler_steps(_time_step, depth);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void HeatField::sweep_euler_steps(float _time_step, int _n_steps)
+{
+  const int n = resolution_;
+
+  // serial: one sweep over all rows per step
+  const int n_bands = team_ ? std::min(team_->size(), n + 2) : 1;
+  if (n_bands == 1)
+  {
+    for (int s = 0; s < _n_steps; ++s)
+    {
+      euler_rows(current_, next_, -1, n + 1, _time_step);
+      swap();
+    }
+    return;
+  }
+
+  // parallel: band b computes step s from buffer s%2 into buffer (s+1)%2.
+  // It reads the last row of band b-1 and the first row of band b+1, and its
+  // output overwrites what they read in step s-1. Both are safe once the two
+  // neighbors have completed s steps, so no global barrier is needed.
+  for (int b = 0; b < n_bands; ++b)
+    progress_[b].steps.store(0, std::memory_order_relaxed);
+
+  float* buffers[2] = {current_, next_};
+
+  team_->run([&](int _thread) {
+    if (_thread >= n_bands) return;
+
+    int begin, end;
+    ThreadTeam::band(-1, n + 1, n_bands, _thread, begin, end);
+
+    std::atomic<int>* left =
+        _thread > 0 ? &progress_[_thread - 1].steps : nullptr;
+    std::atomic<int>* right =
+        _thread + 1 < n_bands ? &progress_[_thread + 1].steps : nullptr;
+
+    for (int s = 0; s < _n_steps; ++s)
+    {
+      while ((left && left->load(std::memory_order_acquire) < s) ||
+             (right && right->load(std::memory_order_acquire) < s))
+        std::this_thread::yield();
+
+      euler_rows(buffers[s % 2], buffers[(s + 1) % 2], begin, end,
+                 _time_step);
+      progress_[_thread].steps.store(s + 1, std::memory_order_release);
+    }
+  });
+
+  if (_n_steps % 2) swap();
+}
+
+void HeatField::blocked_euler_steps(float _time_step, int _depth)
+{
+  const int n       = resolution_;
+  const int n_bands = team_ ? std::min(team_->size(), n + 2) : 1;
+
+  // strips as wide as the cache budget for 3 rows of _depth-1 steps allows,
+  // with the halo on both sides
+  const int line  = FLOATS_PER_LINE;
+  int       width = TILE_CACHE_BYTES / (3 * (_depth - 1) * sizeof(float));
+  width           = std::max(width - 2 * _depth, 16 * line) / line * line;
+
+  auto band = [&](int _thread) {
+    if (_thread >= n_bands) return;
+
+    // same bands as in resize(), so each thread writes the pages it owns
+    int begin, end;
+    ThreadTeam::band(-1, n + 1, n_bands, _thread, begin, end);
+    copy_boundary(current_, next_, begin, end);
+
+    const int i0 = std::max(begin, 1), i1 = std::min(end, n - 1);
+    if (i0 >= i1) return;
+
+    for (int j0 = 1; j0 < n - 1; j0 += width)
+      euler_tile(current_, next_, i0, i1, j0, std::min(j0 + width, n - 1),
+                 _depth, _time_step, scratch_[_thread]);
+  };
+
+  if (n_bands > 1)
+    team_->run(band);
+  else
+    band(0);
+
+  swap();
+}
+
+//=============================================================================
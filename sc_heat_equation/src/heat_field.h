@@ -0,0 +1,176 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "thread_team.h"
+
+#if defined(_MSC_VER)
+#define HEAT_RESTRICT __restrict
+#else
+#define HEAT_RESTRICT __restrict__
+#endif
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Scalar field on an N x N grid, double-buffered for time stepping.
+///
+/// Values are stored row by row. Each row starts at a 64 byte boundary and
+/// its pitch is a multiple of 16 floats, so rows are aligned for SIMD loads
+/// and never share a cache line. The grid is surrounded by one layer of
+/// ghost cells (rows -1 and N, columns -1 and N), which is part of the
+/// padding and can be addressed like regular cells.
+///
+/// With a ThreadTeam the rows are split into one band per thread. Each
+/// thread initializes (first touches) and updates only its own band, so on
+/// NUMA systems its pages are allocated on its node.
+///
+/// Several steps can be fused into one pass over memory (temporal
+/// blocking): each band is processed in tiles that are advanced by up to
+/// block_depth() steps while they are in cache, see explicit_euler_steps().
+class HeatField
+{
+public:
+
+    /// row alignment in bytes
+    static const int ALIGNMENT = 64;
+
+    /// floats per alignment unit, the pitch is a multiple of it
+    static const int FLOATS_PER_LINE = ALIGNMENT / sizeof(float);
+
+    /// cache budget of the intermediate rows of one tile
+    static const int TILE_CACHE_BYTES = 256 * 1024;
+
+    /// empty field, which is processed by the threads of _team (if given)
+    explicit HeatField(ThreadTeam* _team = nullptr);
+
+    /// resize to _resolution x _resolution values, all set to zero
+    void resize(int _resolution);
+
+    /// number of grid points in each direction
+    int resolution() const { return resolution_; }
+
+    /// floats between two rows
+    int pitch() const { return pitch_; }
+
+    /// read-write access to the current value at grid point (i,j),
+    /// -1 <= i,j <= resolution()
+    float& operator()(int _i, int _j) { return current_[index(_i, _j)]; }
+
+    /// read-only access to the current value at grid point (i,j)
+    float operator()(int _i, int _j) const { return current_[index(_i, _j)]; }
+
+    /// row _i of the current values, row(_i)[_j] is value (_i,_j)
+    float* row(int _i) { return current_ + index(_i, 0); }
+    const float* row(int _i) const { return current_ + index(_i, 0); }
+
+    /// row _i of the back buffer, for integrators that write the new values
+    /// themselves and then call swap()
+    float* back_row(int _i) { return next_ + index(_i, 0); }
+
+    /// One explicit Euler step of the heat equation with grid spacing 2,
+    /// boundary values stay fixed. A single fused sweep computes the new
+    /// values into the back buffer, then the buffers are swapped.
+    void explicit_euler_step(float _time_step)
+    {
+        explicit_euler_steps(_time_step, 1);
+    }
+
+    /// _n_steps explicit Euler steps, with the same result as _n_steps
+    /// calls of explicit_euler_step().
+    ///
+    /// With a block depth of 1 every step is one sweep over the grid. The
+    /// threads do not wait for each other between steps: a band only waits
+    /// until its two neighbor bands have finished the previous step.
+    ///
+    /// With a block depth k > 1 the steps are done k at a time. The
+    /// interior is cut into tiles (row band x column strip), and each tile
+    /// is advanced k steps by a wavefront over its rows: step t of row i is
+    /// computed right after step t-1 of row i+1, keeping only three rows
+    /// per step in cache. Tiles read a halo of k cells from the old values
+    /// and compute it redundantly, so they are independent of each other.
+    void explicit_euler_steps(float _time_step, int _n_steps);
+
+    /// number of steps fused into one pass over memory
+    int block_depth() const { return block_depth_; }
+
+    /// set the number of steps fused into one pass over memory (1: none)
+    void set_block_depth(int _depth) { block_depth_ = std::max(1, _depth); }
+
+    /// swap current and back buffer
+    void swap() { std::swap(current_, next_); }
+
+private:
+
+    /// update rows [_begin, _end) of _out from _in, -1 <= _begin <= _end <= N+1
+    void euler_rows(const float* _in, float* _out, int _begin, int _end,
+                    float _time_step) const;
+
+    /// copy the fixed values (boundary and ghost cells) of rows
+    /// [_begin, _end) from _in to _out
+    void copy_boundary(const float* _in, float* _out, int _begin,
+                       int _end) const;
+
+    /// _n_steps steps, one sweep over the grid per step
+    void sweep_euler_steps(float _time_step, int _n_steps);
+
+    /// _depth steps from current_ into next_ in a single pass
+    void blocked_euler_steps(float _time_step, int _depth);
+
+    /// advance the interior tile [_i0, _i1) x [_j0, _j1) of _in by _depth
+    /// steps into _out, with _scratch holding the intermediate rows
+    void euler_tile(const float* _in, float* _out, int _i0, int _i1, int _j0,
+                    int _j1, int _depth, float _time_step,
+                    std::vector<float>& _scratch) const;
+
+    /// position of value (i,j) in a buffer
+    int index(int _i, int _j) const
+    {
+        return (_i + 1) * pitch_ + FLOATS_PER_LINE + _j;
+    }
+
+private:
+
+    /// steps completed by a band, one per cache line
+    struct Progress
+    {
+        std::atomic<int> steps;
+        char             padding[ALIGNMENT - sizeof(std::atomic<int>)];
+    };
+
+    ThreadTeam* team_;
+
+    int resolution_, pitch_;
+
+    /// steps per pass of explicit_euler_steps()
+    int block_depth_;
+
+    /// storage of both buffers, over-allocated for alignment and left
+    /// uninitialized until each thread touches its band
+    std::unique_ptr<float[]> storage_;
+
+    /// progress of the bands in explicit_euler_steps(), one per thread
+    std::unique_ptr<Progress[]> progress_;
+
+    /// intermediate rows of the temporal blocking, one per thread
+    std::vector<std::vector<float>> scratch_;
+
+    /// current values and back buffer, aligned pointers into storage_
+    float *current_, *next_;
+};
+
+
+//=============================================================================
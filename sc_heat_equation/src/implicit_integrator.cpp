@@ -0,0 +1,154 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "implicit_integrator.h"
+
+#include <pmp/Timer.h>
+
+#include <iostream>
+#include <vector>
+
+//== IMPLEMENTATION ==========================================================
+
+ImplicitIntegrator::ImplicitIntegrator()
+    : resolution_(0),
+      theta_(0.0),
+      factorized_(false),
+      factorization_time_(0.0),
+      n_factorizations_(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+void ImplicitIntegrator::clear()
+{
+  factorized_ = false;
+  resolution_ = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+bool ImplicitIntegrator::factorize(int _resolution, Scalar _theta)
+{
+  if (factorized_ && _resolution == resolution_ && _theta == theta_)
+    return true;
+
+  pmp::Timer timer;
+  timer.start();
+
+  resolution_ = _resolution;
+  theta_      = _theta;
+  factorized_ = false;
+
+  // L u = (sum of the 4 neighbors - 4 u) / 4 on the interior; neighbors on
+  // the boundary are known and go to the right hand side
+  const int    r = _resolution;
+  const int    n = (r - 2) * (r - 2);
+  const Scalar c = _theta / 4.0;
+
+  typedef Eigen::Triplet<Scalar> Triplet;
+  std::vector<Triplet>           triplets;
+  triplets.reserve(5 * n);
+
+  for (int i = 1; i < r - 1; ++i)
+  {
+    for (int j = 1; j < r - 1; ++j)
+    {
+      const int k = idx(i, j);
+      triplets.push_back(Triplet(k, k, 1.0 + 4.0 * c));
+      if (i > 1) triplets.push_back(Triplet(k, idx(i - 1, j), -c));
+      if (i < r - 2) triplets.push_back(Triplet(k, idx(i + 1, j), -c));
+      if (j > 1) triplets.push_back(Triplet(k, idx(i, j - 1), -c));
+      if (j < r - 2) triplets.push_back(Triplet(k, idx(i, j + 1), -c));
+    }
+  }
+
+  SparseMatrix A(n, n);
+  A.setFromTriplets(triplets.begin(), triplets.end());
+
+  // symmetric positive definite: sparse Cholesky with fill-reducing ordering
+  solver_.compute(A);
+
+  timer.stop();
+  factorization_time_ = timer.elapsed();
+
+  if (solver_.info() != Eigen::Success)
+  {
+    std::cerr << "ImplicitIntegrator: factorization failed\n";
+    return false;
+  }
+  ++n_factorizations_;
+
+  std::cout << "ImplicitIntegrator: factorized " << n << " x " << n
+            << " system in " << timer << std::endl;
+
+  factorized_ = true;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool ImplicitIntegrator::step(HeatField& _field, Scalar _time_step,
+                              Method _method, int _n_steps)
+{
+  const int r = _field.resolution();
+  if (r < 3) return true;
+
+  const Scalar theta =
+      (_method == CRANK_NICOLSON) ? 0.5 * _time_step : _time_step;
+  if (!factorize(r, theta)) return false;
+
+  // weight of the old values' Laplacian on the right hand side
+  const Scalar c_old = (_method == CRANK_NICOLSON) ? theta / 4.0 : 0.0;
+  const Scalar c_new = theta / 4.0;
+
+  b_.resize((r - 2) * (r - 2));
+
+  for (int s = 0; s < _n_steps; ++s)
+  {
+    for (int i = 1; i < r - 1; ++i)
+    {
+      const float* up   = _field.row(i - 1);
+      const float* mid  = _field.row(i);
+      const float* down = _field.row(i + 1);
+
+      for (int j = 1; j < r - 1; ++j)
+      {
+        Scalar b = mid[j];
+
+        // explicit half (Crank-Nicolson only)
+        if (c_old != 0.0)
+          b += c_old * (Scalar(up[j]) + down[j] + mid[j - 1] + mid[j + 1] -
+                        4.0 * mid[j]);
+
+        // fixed boundary neighbors of the implicit half
+        if (i == 1) b += c_new * up[j];
+        if (i == r - 2) b += c_new * down[j];
+        if (j == 1) b += c_new * mid[j - 1];
+        if (j == r - 2) b += c_new * mid[j + 1];
+
+        b_(idx(i, j)) = b;
+      }
+    }
+
+    x_ = solver_.solve(b_);
+
+    for (int i = 1; i < r - 1; ++i)
+    {
+      float* u = _field.row(i);
+      for (int j = 1; j < r - 1; ++j) u[j] = x_(idx(i, j));
+    }
+  }
+
+  return true;
+}
+
+//=============================================================================
@@ -0,0 +1,86 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <Eigen/Sparse>
+#include "heat_field.h"
+#include "types.h"
+
+//== CLASS DEFINITION =========================================================
+
+/// Unconditionally stable time integration of the heat equation
+/// u' = L u, with L the 5-point Laplacian for grid spacing 2 and fixed
+/// boundary values (the same discretization as the explicit Euler step).
+///
+/// Implicit Euler solves (I - dt L) u' = u, Crank-Nicolson solves
+/// (I - dt/2 L) u' = (I + dt/2 L) u. The matrix only depends on the
+/// resolution and on dt (dt/2 for Crank-Nicolson). Its sparse Cholesky
+/// factorization is computed once and reused as long as these do not
+/// change, so a step costs one pair of sparse triangular solves.
+class ImplicitIntegrator
+{
+public:
+
+    /// available methods
+    enum Method
+    {
+        IMPLICIT_EULER=0,
+        CRANK_NICOLSON=1
+    };
+
+    /// constructor
+    ImplicitIntegrator();
+
+    /// advance _field by _n_steps steps of size _time_step with _method.
+    /// Returns false if the factorization failed.
+    bool step(HeatField& _field, Scalar _time_step, Method _method,
+              int _n_steps = 1);
+
+    /// forget the factorization
+    void clear();
+
+    /// time of the last factorization [ms]
+    double factorization_time() const { return factorization_time_; }
+
+    /// number of successful factorizations so far
+    int n_factorizations() const { return n_factorizations_; }
+
+private:
+
+    typedef Eigen::SparseMatrix<Scalar> SparseMatrix;
+
+    /// set up and factorize I - _theta L for an _resolution^2 grid, unless
+    /// this factorization is already available
+    bool factorize(int _resolution, Scalar _theta);
+
+    /// index of interior grid point (i,j) in the linear system
+    int idx(int _i, int _j) const
+    {
+        return (_i - 1) * (resolution_ - 2) + (_j - 1);
+    }
+
+private:
+
+    /// the factorization is valid for this resolution and coefficient
+    int    resolution_;
+    Scalar theta_;
+    bool   factorized_;
+
+    Eigen::SimplicialLDLT<SparseMatrix> solver_;
+
+    /// right hand side and solution
+    VectorX b_, x_;
+
+    double factorization_time_;
+    int    n_factorizations_;
+};
+
+//=============================================================================
@@ -0,0 +1,139 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <vector>
+#include "types.h"
+
+//== CLASS DEFINITION =========================================================
+
+/// Geometric multigrid solver for the Poisson equation -Laplace(u) = f on
+/// an N x N grid with fixed boundary values (f = 0 gives the equilibrium
+/// of the heat equation).
+///
+/// On the grid, row i is at height i and column j at position j. The
+/// operator is the usual 5-point stencil, 4 u(i,j) minus the four
+/// neighbors, and f is scaled accordingly (multiplied by the grid spacing
+/// squared).
+///
+/// Each coarser grid keeps every other row and column, and always the last
+/// one. This works for any N: if N-1 is odd, the last coarse interval is
+/// only half as long. The coarse operators therefore use the node positions:
+/// they are the finite-volume discretization of the Laplacian with the
+/// actual spacings, which reduces to the 5-point stencil on uniform grids.
+/// Corrections are prolongated by bilinear interpolation, residuals are
+/// restricted with its transpose (full weighting), and red-black
+/// Gauss-Seidel is the smoother.
+class Multigrid
+{
+public:
+
+    /// cycle types
+    enum Cycle
+    {
+        V_CYCLE=0,
+        F_CYCLE=1
+    };
+
+    /// constructor
+    Multigrid();
+
+    /// set up the grid hierarchy for _resolution x _resolution points. All
+    /// values and the right hand side are set to zero.
+    void resize(int _resolution);
+
+    /// bytes of the hierarchy for _resolution x _resolution points
+    static size_t bytes(int _resolution);
+
+    /// number of grid points in each direction
+    int resolution() const { return levels_.empty() ? 0 : levels_[0].n; }
+
+    /// number of grids in the hierarchy
+    int n_levels() const { return levels_.size(); }
+
+    /// read-write access to value (i,j) of the solution. Boundary values
+    /// are kept, inner values are the initial guess of solve().
+    Scalar& u(int _i, int _j) { return levels_[0].u[_i * resolution() + _j]; }
+
+    /// read-write access to the right hand side at (i,j)
+    Scalar& f(int _i, int _j) { return levels_[0].f[_i * resolution() + _j]; }
+
+    /// run _cycle until the residual norm relative to the norm of the right
+    /// hand side (including the boundary values) is below _tolerance, at
+    /// most _max_cycles times. Returns the number of cycles.
+    int solve(Scalar _tolerance, int _max_cycles, Cycle _cycle = V_CYCLE);
+
+    /// relative residual after the last solve()
+    Scalar residual() const { return residual_; }
+
+public:
+
+    /// Gauss-Seidel sweeps before and after the coarse grid correction
+    int pre_smoothing, post_smoothing;
+
+private:
+
+    /// one grid of the hierarchy
+    struct Level
+    {
+        int  n;       ///< grid points in each direction
+        bool uniform; ///< unit spacing (5-point stencil)?
+
+        /// position of row/column k, in units of the finest spacing
+        std::vector<Scalar> x;
+
+        /// finite-volume coefficients of row/column k: half the distance
+        /// between its neighbors, and inverse distance to the left/right one
+        std::vector<Scalar> area, left, right;
+
+        /// for the prolongation to this level: the coarse rows/columns k is
+        /// interpolated from, and their weights
+        std::vector<int>    coarse0, coarse1;
+        std::vector<Scalar> weight0, weight1;
+
+        /// solution, right hand side and residual, row by row
+        std::vector<Scalar> u, f, r;
+
+        /// residual restricted along the rows, N x (coarse N)
+        std::vector<Scalar> t;
+    };
+
+    /// set up the coefficients of a level from its positions
+    void init_level(Level& _level);
+
+    /// _sweeps red-black Gauss-Seidel sweeps on _level
+    void smooth(Level& _level, int _sweeps);
+
+    /// Gauss-Seidel update of the points of color _color in row _i
+    void smooth_row(Level& _level, int _i, int _color);
+
+    /// r = f - A u on _level, returns the 2-norm of r
+    Scalar residual(Level& _level);
+
+    /// norm of the right hand side, including the boundary values
+    Scalar rhs_norm(const Level& _level) const;
+
+    /// restrict the residual of level _l to the right hand side of _l+1
+    void restrict_residual(int _l);
+
+    /// add the prolongated solution of level _l+1 to level _l
+    void prolongate(int _l);
+
+    /// one cycle on level _l
+    void cycle(int _l, Cycle _cycle);
+
+private:
+
+    std::vector<Level> levels_;
+    Scalar             residual_;
+};
+
+//=============================================================================
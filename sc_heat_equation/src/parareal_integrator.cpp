@@ -0,0 +1,177 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "parareal_integrator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+//== IMPLEMENTATION ==========================================================
+
+PararealIntegrator::PararealIntegrator(ThreadTeam* _team)
+    : team_(_team),
+      n_slices_(_team ? _team->size() : 1),
+      tolerance_(1e-4f),
+      iterations_(0),
+      coarse_integrator_(_team),
+      coarse_field_(_team)
+{
+  const int n_threads = team_ ? team_->size() : 1;
+  for (int t = 0; t < n_threads; ++t)
+    fine_fields_.push_back(std::unique_ptr<HeatField>(new HeatField));
+}
+
+//-----------------------------------------------------------------------------
+
+void PararealIntegrator::store(const HeatField& _field,
+                               std::vector<float>& _state)
+{
+  const int n = _field.resolution();
+  _state.resize(size_t(n) * n);
+  for (int i = 0; i < n; ++i)
+    memcpy(&_state[size_t(i) * n], _field.row(i), n * sizeof(float));
+}
+
+//-----------------------------------------------------------------------------
+
+void PararealIntegrator::load(const std::vector<float>& _state,
+                              HeatField& _field)
+{
+  const int n = _field.resolution();
+  for (int i = 0; i < n; ++i)
+    memcpy(_field.row(i), &_state[size_t(i) * n], n * sizeof(float));
+}
+
+//-----------------------------------------------------------------------------
+
+size_t PararealIntegrator::bytes(int _resolution, int _n_steps) const
+{
+  const int    n_threads = team_ ? team_->size() : 1;
+  const size_t n_slices  = std::min(n_slices_, std::max(_n_steps, 1));
+  const size_t state     = size_t(_resolution) * _resolution * sizeof(float);
+
+  // a HeatField has two buffers of N+2 padded rows
+  const int    line  = HeatField::FLOATS_PER_LINE;
+  const size_t pitch = (line + _resolution + 1 + line - 1) / line * line;
+  const size_t field = 2 * size_t(_resolution + 2) * pitch * sizeof(float);
+
+  return (3 * n_slices + 1) * state + (n_threads + 1) * field;
+}
+
+//-----------------------------------------------------------------------------
+
+void PararealIntegrator::fine(int _first, float _time_step, int _n_steps)
+{
+  const int n_threads = team_ ? team_->size() : 1;
+  const int n         = coarse_field_.resolution();
+  const int n_slices  = fine_values_.size();
+  const int depth     = coarse_field_.block_depth();
+
+  // each thread propagates its slices in its own field, serially
+  auto propagate = [&](int _thread) {
+    HeatField& field = *fine_fields_[_thread];
+    for (int k = _first + _thread; k < n_slices; k += n_threads)
+    {
+      if (field.resolution() != n) field.resize(n);
+      field.set_block_depth(depth);
+      load(states_[k], field);
+      field.explicit_euler_steps(_time_step, _n_steps);
+      store(field, fine_values_[k]);
+    }
+  };
+
+  if (n_threads > 1 && n_slices - _first > 1)
+    team_->run(propagate);
+  else
+    for (int t = 0; t < n_threads; ++t) propagate(t);
+}
+
+//-----------------------------------------------------------------------------
+
+void PararealIntegrator::coarse(int _k, float _time_step)
+{
+  load(states_[_k], coarse_field_);
+  coarse_integrator_.step(coarse_field_, _time_step, 1,
+                          ADI_Integrator::IMPLICIT_SPLITTING);
+}
+
+//-----------------------------------------------------------------------------
+
+void PararealIntegrator::step(HeatField& _field, float _time_step,
+                              int _n_steps)
+{
+  const int n = _field.resolution();
+  if (n < 3 || _n_steps < 1) return;
+
+  // K slices of equal length, so the coarse step is the same for all; the
+  // remaining steps are done serially at the end
+  const int   n_slices    = std::min(n_slices_, _n_steps);
+  const int   slice_steps = _n_steps / n_slices;
+  const int   rest        = _n_steps - n_slices * slice_steps;
+  const float coarse_step = slice_steps * _time_step;
+
+  if (coarse_field_.resolution() != n) coarse_field_.resize(n);
+  coarse_field_.set_block_depth(_field.block_depth());
+
+  states_.resize(n_slices + 1);
+  fine_values_.resize(n_slices);
+  coarse_values_.resize(n_slices);
+
+  // prediction by the coarse propagator alone
+  store(_field, states_[0]);
+  for (int k = 0; k < n_slices; ++k)
+  {
+    coarse(k, coarse_step);
+    store(coarse_field_, coarse_values_[k]);
+    states_[k + 1] = coarse_values_[k];
+  }
+
+  iterations_ = 0;
+  for (int first = 0; first < n_slices; ++first)
+  {
+    fine(first, _time_step, slice_steps);
+    ++iterations_;
+
+    // slice 'first' starts from an exact state, so its end is exact
+    states_[first + 1] = fine_values_[first];
+
+    // serial correction sweep
+    float change = 0.0f;
+    for (int k = first + 1; k < n_slices; ++k)
+    {
+      coarse(k, coarse_step);
+
+      float* HEAT_RESTRICT       u     = states_[k + 1].data();
+      float* HEAT_RESTRICT       g_old = coarse_values_[k].data();
+      const float* HEAT_RESTRICT f     = fine_values_[k].data();
+
+      for (int i = 0; i < n; ++i)
+      {
+        const float* HEAT_RESTRICT g = coarse_field_.row(i);
+        const size_t               o = size_t(i) * n;
+        for (int j = 0; j < n; ++j)
+        {
+          const float v = g[j] + (f[o + j] - g_old[o + j]);
+          change        = std::max(change, std::fabs(v - u[o + j]));
+          u[o + j]      = v;
+          g_old[o + j]  = g[j];
+        }
+      }
+    }
+
+    if (change <= tolerance_) break;
+  }
+
+  load(states_[n_slices], _field);
+  if (rest) _field.explicit_euler_steps(_time_step, rest);
+}
+
+//=============================================================================
@@ -0,0 +1,103 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "heat_field.h"
+#include "adi_integrator.h"
+#include "thread_team.h"
+
+//== CLASS DEFINITION =========================================================
+
+/// Parareal time integration: explicit Euler steps, parallel in time.
+///
+/// The time interval of n explicit Euler steps is cut into K slices. A
+/// coarse propagator G (one implicit ADI step over a whole slice, with the
+/// damping of implicit Euler) is cheap but inaccurate, the fine propagator
+/// F (the explicit Euler steps of a slice) is accurate but expensive. The
+/// states U_k at the slice boundaries are first predicted by G alone, then
+/// corrected by
+///
+///     U_k+1 = G(U_k new) + F(U_k old) - G(U_k old).
+///
+/// The F of all slices are independent and run in parallel, one slice per
+/// thread of a ThreadTeam; only the cheap G sweep is serial. After
+/// iteration j the first j slices are exact, so the result equals the
+/// serial explicit Euler steps (up to rounding) after at most K
+/// iterations. Usually the corrections fall below the tolerance much
+/// earlier, and with j iterations the speedup over serial time stepping
+/// is at most K / j. This pays off when the threads are better used along
+/// the time axis than within a grid that is too small to split further.
+class PararealIntegrator
+{
+public:
+
+    /// constructor, the slices are distributed over the threads of _team
+    /// (if given)
+    explicit PararealIntegrator(ThreadTeam* _team = nullptr);
+
+    /// advance _field by _n_steps explicit Euler steps of size _time_step
+    void step(HeatField& _field, float _time_step, int _n_steps);
+
+    /// number of time slices
+    int slices() const { return n_slices_; }
+
+    /// set the number of time slices (default: one per thread)
+    void set_slices(int _slices) { n_slices_ = std::max(1, _slices); }
+
+    /// the iteration stops when no value changes by more than _tolerance
+    /// (default 1e-4)
+    void set_tolerance(float _tolerance) { tolerance_ = _tolerance; }
+
+    /// number of parareal iterations of the last step()
+    int iterations() const { return iterations_; }
+
+    /// bytes of step() for an _resolution^2 grid, _n_steps steps and this
+    /// number of slices and threads: 3K+1 states and one field per thread
+    size_t bytes(int _resolution, int _n_steps) const;
+
+private:
+
+    /// copy the grid values of _field to _state
+    static void store(const HeatField& _field, std::vector<float>& _state);
+
+    /// copy _state to the grid values of _field
+    static void load(const std::vector<float>& _state, HeatField& _field);
+
+    /// fine propagation of slices [_first, K) with _n_steps steps each
+    void fine(int _first, float _time_step, int _n_steps);
+
+    /// coarse propagation of state _k, the result is in coarse_field_
+    void coarse(int _k, float _time_step);
+
+private:
+
+    ThreadTeam* team_;
+
+    int   n_slices_;
+    float tolerance_;
+    int   iterations_;
+
+    /// coarse propagator and its work field
+    ADI_Integrator coarse_integrator_;
+    HeatField      coarse_field_;
+
+    /// work fields of the fine propagator, one per thread
+    std::vector<std::unique_ptr<HeatField>> fine_fields_;
+
+    /// states U_k at the slice boundaries (K+1), and F(U_k), G(U_k) of the
+    /// last iteration (K), N x N values each
+    std::vector<std::vector<float>> states_, fine_values_, coarse_values_;
+};
+
+//=============================================================================
@@ -0,0 +1,867 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "quadtree_field.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//== IMPLEMENTATION ==========================================================
+
+QuadtreeField::QuadtreeField(ThreadTeam* _team)
+    : team_(_team),
+      n_(0),
+      resolution_(0),
+      levels_(0),
+      finest_(0),
+      tolerance_(0.005f),
+      steps_(0),
+      current_(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+void QuadtreeField::clear()
+{
+  nodes_.clear();
+  blocks_.clear();
+  free_blocks_.clear();
+  leaves_.clear();
+  neighbors_.clear();
+  ghost_range_.clear();
+  ghosts_.clear();
+  terms_.clear();
+  values_[0].clear();
+  values_[1].clear();
+  current_ = 0;
+  steps_   = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+double QuadtreeField::coverage() const
+{
+  const double n = resolution_ - 1;
+  return double(leaves_.size()) * BLOCK * BLOCK / (n * n);
+}
+
+//-----------------------------------------------------------------------------
+
+void QuadtreeField::for_leaves(const std::function<void(int _b)>& _task) const
+{
+  const int n_threads = team_ ? team_->size() : 1;
+  auto      band      = [&](int _thread) {
+    int begin, end;
+    ThreadTeam::band(0, leaves_.size(), n_threads, _thread, begin, end);
+    for (int k = begin; k < end; ++k) _task(leaves_[k]);
+  };
+
+  if (n_threads > 1 && leaves_.size() > 1)
+    team_->run(band);
+  else
+    for (int b : leaves_) _task(b);
+}
+
+//-----------------------------------------------------------------------------
+
+int QuadtreeField::find_leaf(int _I, int _J) const
+{
+  // descend from the root
+  for (int level = 0;; ++level)
+  {
+    const int span = BLOCK * stride(level);
+    const int b    = nodes_.find(key(level, _I / span, _J / span))->second;
+    if (b != INTERNAL) return b;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+float QuadtreeField::value(int _I, int _J) const
+{
+  const int m = resolution_ - 1;
+  if (_I == m) return boundary_[_J];
+  if (_J == m) return boundary_[m + 1 + _I];
+
+  const int    b  = find_leaf(_I, _J);
+  const Block& bl = blocks_[b];
+  const int    s  = stride(bl.level);
+  const int    di = _I % s, dj = _J % s;
+
+  if (di == 0 && dj == 0)
+  {
+    const int r = _I / s - bl.bi * BLOCK, c = _J / s - bl.bj * BLOCK;
+    return values(b)[(r + 1) * PADDED + c + 1];
+  }
+
+  // between the points of the leaf: interpolate. The points on the far
+  // side may belong to a neighbor, possibly a coarser one.
+  const int   I0 = _I - di, J0 = _J - dj;
+  const float u = float(di) / s, v = float(dj) / s;
+  if (dj == 0) return (1.0f - u) * value(I0, _J) + u * value(I0 + s, _J);
+  if (di == 0) return (1.0f - v) * value(_I, J0) + v * value(_I, J0 + s);
+  return (1.0f - u) * ((1.0f - v) * value(I0, J0) + v * value(I0, J0 + s)) +
+         u * ((1.0f - v) * value(I0 + s, J0) + v * value(I0 + s, J0 + s));
+}
+
+//-----------------------------------------------------------------------------
+
+void QuadtreeField::value_terms(int _I, int _J, float _weight,
+                                std::vector<Term>& _terms) const
+{
+  // the same recursion as value(), collecting the weights instead
+  const int m = resolution_ - 1;
+  if (_I == m || _J == m)
+  {
+    Term t = {-1 - (_I == m ? _J : m + 1 + _I), _weight};
+    _terms.push_back(t);
+    return;
+  }
+
+  const int    b  = find_leaf(_I, _J);
+  const Block& bl = blocks_[b];
+  const int    s  = stride(bl.level);
+  const int    di = _I % s, dj = _J % s;
+
+  if (di == 0 && dj == 0)
+  {
+    const int r = _I / s - bl.bi * BLOCK, c = _J / s - bl.bj * BLOCK;
+    Term      t = {b * CELLS + (r + 1) * PADDED + c + 1, _weight};
+    _terms.push_back(t);
+    return;
+  }
+
+  const int   I0 = _I - di, J0 = _J - dj;
+  const float u = float(di) / s, v = float(dj) / s;
+  if (dj == 0)
+  {
+    value_terms(I0, _J, (1.0f - u) * _weight, _terms);
+    value_terms(I0 + s, _J, u * _weight, _terms);
+  }
+  else if (di == 0)
+  {
+    value_terms(_I, J0, (1.0f - v) * _weight, _terms);
+    value_terms(_I, J0 + s, v * _weight, _terms);
+  }
+  else
+  {
+    value_terms(I0, J0, (1.0f - u) * (1.0f - v) * _weight, _terms);
+    value_terms(I0, J0 + s, (1.0f - u) * v * _weight, _terms);
+    value_terms(I0 + s, J0, u * (1.0f - v) * _weight, _terms);
+    value_terms(I0 + s, J0 + s, u * v * _weight, _terms);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+float QuadtreeField::sample(const HeatField& _field, int _I, int _J) const
+{
+  // point I of the finest level is at I (n-1)/(M-1) on the grid
+  const double scale = double(n_ - 1) / (resolution_ - 1);
+  const double x = _I * scale, y = _J * scale;
+  const int    i = std::min(int(x), n_ - 2), j = std::min(int(y), n_ - 2);
+  const float  u = x - i, v = y - j;
+
+  return (1.0f - u) * ((1.0f - v) * _field(i, j) + v * _field(i, j + 1)) +
+         u * ((1.0f - v) * _field(i + 1, j) + v * _field(i + 1, j + 1));
+}
+
+//-----------------------------------------------------------------------------
+
+int QuadtreeField::new_block(int _level, int _bi, int _bj)
+{
+  int b;
+  if (free_blocks_.empty())
+  {
+    b = blocks_.size();
+    blocks_.push_back(Block());
+    values_[0].resize(blocks_.size() * CELLS);
+    values_[1].resize(blocks_.size() * CELLS);
+  }
+  else
+  {
+    b = free_blocks_.back();
+    free_blocks_.pop_back();
+  }
+
+  // not adapted before its values have been measured
+  Block block = {_level, _bi, _bj, std::numeric_limits<float>::max()};
+  blocks_[b]  = block;
+  nodes_[key(_level, _bi, _bj)] = b;
+  return b;
+}
+
+//-----------------------------------------------------------------------------
+
+void QuadtreeField::fill(int _b, const Sampler& _f)
+{
+  const Block& bl = blocks_[_b];
+  const int    s  = stride(bl.level);
+  const int    I0 = bl.bi * BLOCK * s, J0 = bl.bj * BLOCK * s;
+  float*       v  = values(_b);
+
+  for (int r = 0; r < BLOCK; ++r)
+    for (int c = 0; c < BLOCK; ++c)
+      v[(r + 1) * PADDED + c + 1] = _f(I0 + r * s, J0 + c * s);
+}
+
+//-----------------------------------------------------------------------------
+
+void QuadtreeField::refine(int _b, const Sampler& _f)
+{
+  const Block parent = blocks_[_b];
+
+  // the children are filled while the parent is still a leaf, so _f can
+  // interpolate the parent's values
+  for (int ci = 0; ci < 2; ++ci)
+    for (int cj = 0; cj < 2; ++cj)
+      fill(new_block(parent.level + 1, 2 * parent.bi + ci,
+                     2 * parent.bj + cj),
+           _f);
+
+  nodes_[key(parent.level, parent.bi, parent.bj)] = INTERNAL;
+  blocks_[_b].level = -1;
+  free_blocks_.push_back(_b);
+}
+
+//-----------------------------------------------------------------------------
+
+bool QuadtreeField::too_coarse(int _b) const
+{
+  const Block& bl = blocks_[_b];
+  const int    n  = 1 << bl.level;
+  const int    di[4] = {-1, 1, 0, 0}, dj[4] = {0, 0, -1, 1};
+
+  for (int k = 0; k < 4; ++k)
+  {
+    const int ni = bl.bi + di[k], nj = bl.bj + dj[k];
+    if (ni < 0 || nj < 0 || ni >= n || nj >= n) continue;
+
+    auto it = nodes_.find(key(bl.level, ni, nj));
+    if (it == nodes_.end() || it->second != INTERNAL) continue;
+
+    // the two children of the neighbor that touch this block
+    for (int t = 0; t < 2; ++t)
+    {
+      const int ci = di[k] ? (di[k] < 0 ? 1 : 0) : t;
+      const int cj = dj[k] ? (dj[k] < 0 ? 1 : 0) : t;
+      auto      c  = nodes_.find(key(bl.level + 1, 2 * ni + ci, 2 * nj + cj));
+      if (c != nodes_.end() && c->second == INTERNAL) return true;
+    }
+  }
+
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+
+void QuadtreeField::balance(const Sampler& _f)
+{
+  // refining a leaf can unbalance its coarser neighbors, so repeat until
+  // nothing changes
+  for (bool changed = true; changed;)
+  {
+    changed = false;
+    for (size_t b = 0; b < blocks_.size(); ++b)
+    {
+      if (blocks_[b].level >= 0 && too_coarse(b))
+      {
+        refine(b, _f);
+        changed = true;
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+bool QuadtreeField::coarsen(int _level, int _bi, int _bj)
+{
+  int children[4];
+  for (int k = 0; k < 4; ++k)
+  {
+    auto it = nodes_.find(key(_level + 1, 2 * _bi + k / 2, 2 * _bj + k % 2));
+    if (it == nodes_.end() || it->second == INTERNAL) return false;
+    children[k] = it->second;
+  }
+
+  // the merged leaf must not get a neighbor two levels finer
+  const int n     = 1 << _level;
+  const int di[4] = {-1, 1, 0, 0}, dj[4] = {0, 0, -1, 1};
+  for (int k = 0; k < 4; ++k)
+  {
+    const int ni = _bi + di[k], nj = _bj + dj[k];
+    if (ni < 0 || nj < 0 || ni >= n || nj >= n) continue;
+
+    auto it = nodes_.find(key(_level, ni, nj));
+    if (it == nodes_.end() || it->second != INTERNAL) continue;
+
+    for (int t = 0; t < 2; ++t)
+    {
+      const int ci = di[k] ? (di[k] < 0 ? 1 : 0) : t;
+      const int cj = dj[k] ? (dj[k] < 0 ? 1 : 0) : t;
+      auto      c  = nodes_.find(key(_level + 1, 2 * ni + ci, 2 * nj + cj));
+      if (c != nodes_.end() && c->second == INTERNAL) return false;
+    }
+  }
+
+  // every other point of the children is a point of the parent
+  const int b = new_block(_level, _bi, _bj);
+  float*    v = values(b);
+  for (int r = 0; r < BLOCK; ++r)
+  {
+    for (int c = 0; c < BLOCK; ++c)
+    {
+      const int    child = (2 * r / BLOCK) * 2 + 2 * c / BLOCK;
+      const float* w     = values(children[child]);
+      const int    cr = 2 * r % BLOCK, cc = 2 * c % BLOCK;
+      v[(r + 1) * PADDED + c + 1] = w[(cr + 1) * PADDED + cc + 1];
+    }
+  }
+
+  for (int k = 0; k < 4; ++k)
+  {
+    const Block& child = blocks_[children[k]];
+    nodes_.erase(key(child.level, child.bi, child.bj));
+    blocks_[children[k]].level = -1;
+    free_blocks_.push_back(children[k]);
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void QuadtreeField::update_leaves()
+{
+  leaves_.clear();
+  finest_ = 0;
+  for (size_t b = 0; b < blocks_.size(); ++b)
+  {
+    if (blocks_[b].level >= 0)
+    {
+      leaves_.push_back(b);
+      finest_ = std::max(finest_, blocks_[b].level);
+    }
+  }
+
+  // Ghost sources. Looking them up in the quadtree costs more than the
+  // time step itself, so they are collected once per change: sides with
+  // a neighbor of the same level are copied, all other ghost values are
+  // sums of weighted values.
+  const int m = resolution_ - 1;
+  neighbors_.assign(4 * blocks_.size(), -1);
+  ghost_range_.assign(2 * blocks_.size(), 0);
+  ghosts_.clear();
+  terms_.clear();
+
+  for (int b : leaves_)
+  {
+    const Block& bl = blocks_[b];
+    const int    s  = stride(bl.level);
+    const int    I0 = bl.bi * BLOCK * s, J0 = bl.bj * BLOCK * s;
+    const int    I1 = I0 + BLOCK * s, J1 = J0 + BLOCK * s;
+
+    auto add = [&](int _r, int _c, int _I, int _J) {
+      Ghost g = {(_r + 1) * PADDED + _c + 1, int(terms_.size()), 0};
+      value_terms(_I, _J, 1.0f, terms_);
+      g.last = terms_.size();
+      ghosts_.push_back(g);
+    };
+
+    // the sides: rows -1 and BLOCK, columns -1 and BLOCK. The first row
+    // and column of the domain are fixed and need no ghost values.
+    const bool needed[4] = {I0 > 0, true, J0 > 0, true};
+    const int  di[4] = {-1, 1, 0, 0}, dj[4] = {0, 0, -1, 1};
+
+    ghost_range_[2 * b] = ghosts_.size();
+    for (int k = 0; k < 4; ++k)
+    {
+      if (!needed[k]) continue;
+
+      const bool inside = (k == 1) ? I1 < m : (k == 3) ? J1 < m : true;
+      auto it = nodes_.find(key(bl.level, bl.bi + di[k], bl.bj + dj[k]));
+      if (inside && it != nodes_.end() && it->second != INTERNAL)
+      {
+        neighbors_[4 * b + k] = it->second;
+        continue;
+      }
+
+      for (int t = 0; t < BLOCK; ++t)
+      {
+        switch (k)
+        {
+          case 0: add(-1, t, I0 - s, J0 + t * s); break;
+          case 1: add(BLOCK, t, I1, J0 + t * s); break;
+          case 2: add(t, -1, I0 + t * s, J0 - s); break;
+          case 3: add(t, BLOCK, I0 + t * s, J1); break;
+        }
+      }
+    }
+
+    // the far corner, for interpolation and drawing
+    add(BLOCK, BLOCK, I1, J1);
+    ghost_range_[2 * b + 1] = ghosts_.size();
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void QuadtreeField::fill_ghosts(int _b)
+{
+  float*       v   = values(_b);
+  const float* all = values_[current_].data();
+  const int*   nb  = &neighbors_[4 * _b];
+
+  // copies from neighbors of the same level
+  if (nb[0] >= 0) std::copy_n(values(nb[0]) + BLOCK * PADDED + 1, BLOCK, v + 1);
+  if (nb[1] >= 0)
+    std::copy_n(values(nb[1]) + PADDED + 1, BLOCK,
+                v + (BLOCK + 1) * PADDED + 1);
+  if (nb[2] >= 0)
+  {
+    const float* w = values(nb[2]);
+    for (int r = 1; r <= BLOCK; ++r) v[r * PADDED] = w[r * PADDED + BLOCK];
+  }
+  if (nb[3] >= 0)
+  {
+    const float* w = values(nb[3]);
+    for (int r = 1; r <= BLOCK; ++r)
+      v[r * PADDED + BLOCK + 1] = w[r * PADDED + 1];
+  }
+
+  // all others
+  for (int g = ghost_range_[2 * _b]; g < ghost_range_[2 * _b + 1]; ++g)
+  {
+    const Ghost& ghost = ghosts_[g];
+    float        sum   = 0.0f;
+    for (int t = ghost.first; t < ghost.last; ++t)
+    {
+      const Term& term = terms_[t];
+      sum += term.weight * (term.offset >= 0 ? all[term.offset]
+                                             : boundary_[-1 - term.offset]);
+    }
+    v[ghost.index] = sum;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void QuadtreeField::fill_ghosts()
+{
+  for_leaves([this](int _b) { fill_ghosts(_b); });
+}
+
+//-----------------------------------------------------------------------------
+
+void QuadtreeField::euler_block(int _b, float _time_step)
+{
+  const Block& bl = blocks_[_b];
+  const int    s  = stride(bl.level);
+
+  // the Laplacian of the finest level, for points s times further apart
+  const float a = _time_step / (4.0f * s * s);
+  const float d = 1.0f - 4.0f * a;
+
+  const float* in  = values(_b);
+  float*       out = values(_b, 1);
+
+  // the first row and column of the domain are fixed
+  const int r0 = (bl.bi == 0) ? 1 : 0;
+  const int c0 = (bl.bj == 0) ? 1 : 0;
+  if (r0) std::copy_n(in + PADDED + 1, BLOCK, out + PADDED + 1);
+  if (c0)
+    for (int r = 0; r < BLOCK; ++r)
+      out[(r + 1) * PADDED + 1] = in[(r + 1) * PADDED + 1];
+
+  for (int r = r0; r < BLOCK; ++r)
+  {
+    const float* HEAT_RESTRICT up   = in + r * PADDED + 1;
+    const float* HEAT_RESTRICT mid  = up + PADDED;
+    const float* HEAT_RESTRICT down = mid + PADDED;
+    float* HEAT_RESTRICT       u    = out + (r + 1) * PADDED + 1;
+
+    for (int c = c0; c < BLOCK; ++c)
+      u[c] = d * mid[c] + a * ((up[c] + down[c]) + (mid[c - 1] + mid[c + 1]));
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void QuadtreeField::regrid()
+{
+  // largest difference of neighboring values in each leaf, including the
+  // ghost values (except for the missing ones before the first row and
+  // column of the domain)
+  for_leaves([this](int _b) {
+    const Block& bl = blocks_[_b];
+    const int    r0 = (bl.bi == 0) ? 0 : -1, c0 = (bl.bj == 0) ? 0 : -1;
+    const float* v  = values(_b);
+    float        g  = 0.0f;
+    // differences along the rows, then along the columns; only the far
+    // corner of the ghost layer is filled
+    for (int r = 0; r <= BLOCK; ++r)
+    {
+      const float* row = v + (r + 1) * PADDED + 1;
+      for (int c = (r < BLOCK ? c0 : 0); c < BLOCK; ++c)
+        g = std::max(g, std::abs(row[c + 1] - row[c]));
+    }
+    for (int r = r0; r < BLOCK; ++r)
+    {
+      const float* row  = v + (r + 1) * PADDED + 1;
+      const float* next = row + PADDED;
+      const int    c1   = (r < 0) ? BLOCK : BLOCK + 1;
+      for (int c = 0; c < c1; ++c)
+        g = std::max(g, std::abs(next[c] - row[c]));
+    }
+    blocks_[_b].steepness = g;
+  });
+
+  // one block of margin: a leaf is as steep as the steepest leaf its ghost
+  // values come from
+  std::vector<float> margin(blocks_.size(), 0.0f);
+  for_leaves([&](int _b) {
+    float g = blocks_[_b].steepness;
+    for (int k = 0; k < 4; ++k)
+      if (neighbors_[4 * _b + k] >= 0)
+        g = std::max(g, blocks_[neighbors_[4 * _b + k]].steepness);
+    for (int h = ghost_range_[2 * _b]; h < ghost_range_[2 * _b + 1]; ++h)
+      for (int t = ghosts_[h].first; t < ghosts_[h].last; ++t)
+        if (terms_[t].offset >= 0)
+          g = std::max(g, blocks_[terms_[t].offset / CELLS].steepness);
+    margin[_b] = g;
+  });
+  for (int b : leaves_) blocks_[b].steepness = margin[b];
+
+  const Sampler interpolate = [this](int _I, int _J) {
+    return value(_I, _J);
+  };
+
+  // refine steep leaves
+  std::vector<int> steep;
+  for (int b : leaves_)
+    if (blocks_[b].steepness > tolerance_ && blocks_[b].level < levels_)
+      steep.push_back(b);
+  for (int b : steep) refine(b, interpolate);
+  balance(interpolate);
+  bool changed = !steep.empty();
+
+  // Merge groups of four flat leaves. Their differences roughly double on
+  // the coarser level, a quarter of the tolerance keeps them from being
+  // refined again right away.
+  for (int b : leaves_)
+  {
+    const Block bl = blocks_[b];
+    if (bl.level <= 0 || bl.bi % 2 || bl.bj % 2) continue;
+
+    bool flat = true;
+    for (int k = 0; k < 4 && flat; ++k)
+    {
+      auto it = nodes_.find(key(bl.level, bl.bi + k / 2, bl.bj + k % 2));
+      flat    = (it != nodes_.end() && it->second != INTERNAL &&
+              blocks_[it->second].steepness < 0.25f * tolerance_);
+    }
+    if (flat && coarsen(bl.level - 1, bl.bi / 2, bl.bj / 2)) changed = true;
+  }
+
+  // the ghost values are still filled if nothing has changed
+  if (!changed) return;
+  update_leaves();
+  fill_ghosts();
+}
+
+//-----------------------------------------------------------------------------
+
+void QuadtreeField::load(const HeatField& _field)
+{
+  clear();
+
+  // the finest level has at least as many points as the grid
+  n_      = _field.resolution();
+  levels_ = 0;
+  while (BLOCK << levels_ < n_ - 1) ++levels_;
+  resolution_ = (BLOCK << levels_) + 1;
+
+  const int     m     = resolution_ - 1;
+  const Sampler input = [this, &_field](int _I, int _J) {
+    return sample(_field, _I, _J);
+  };
+
+  boundary_.resize(2 * (m + 1));
+  for (int k = 0; k <= m; ++k)
+  {
+    boundary_[k]         = input(m, k);
+    boundary_[m + 1 + k] = input(k, m);
+  }
+
+  // largest difference of neighboring grid values in the blocks of each
+  // level, from the finest level up. A difference counts for the blocks
+  // of both values, so a jump at a block border refines both sides.
+  std::vector<std::vector<float>> steepness(levels_ + 1);
+  const int                       nb = 1 << levels_;
+  steepness[levels_].assign(size_t(nb) * nb, 0.0f);
+
+  std::vector<int> block(n_);
+  for (int i = 0; i < n_; ++i)
+    block[i] = std::min<int>(int64_t(i) * m / (n_ - 1) / BLOCK, nb - 1);
+
+  auto add = [&](int _i, int _j, float _g) {
+    float& s = steepness[levels_][size_t(block[_i]) * nb + block[_j]];
+    s        = std::max(s, _g);
+  };
+  for (int i = 0; i < n_; ++i)
+  {
+    for (int j = 0; j < n_; ++j)
+    {
+      const float u = _field(i, j);
+      if (i + 1 < n_)
+      {
+        const float g = std::abs(_field(i + 1, j) - u);
+        add(i, j, g);
+        add(i + 1, j, g);
+      }
+      if (j + 1 < n_)
+      {
+        const float g = std::abs(_field(i, j + 1) - u);
+        add(i, j, g);
+        add(i, j + 1, g);
+      }
+    }
+  }
+  // one block of margin, so a front does not leave the refined blocks
+  // before the next adaptation
+  {
+    const std::vector<float> g = steepness[levels_];
+    for (int bi = 0; bi < nb; ++bi)
+      for (int bj = 0; bj < nb; ++bj)
+      {
+        float& s = steepness[levels_][size_t(bi) * nb + bj];
+        for (int i = std::max(bi - 1, 0); i <= std::min(bi + 1, nb - 1); ++i)
+          for (int j = std::max(bj - 1, 0); j <= std::min(bj + 1, nb - 1); ++j)
+            s = std::max(s, g[size_t(i) * nb + j]);
+      }
+  }
+
+  for (int l = levels_ - 1; l >= 0; --l)
+  {
+    const int n = 1 << l;
+    steepness[l].resize(size_t(n) * n);
+    for (int bi = 0; bi < n; ++bi)
+      for (int bj = 0; bj < n; ++bj)
+      {
+        const float* fine = &steepness[l + 1][size_t(2 * bi) * 2 * n + 2 * bj];
+        steepness[l][size_t(bi) * n + bj] =
+            std::max(std::max(fine[0], fine[1]),
+                     std::max(fine[2 * n], fine[2 * n + 1]));
+      }
+  }
+
+  // top-down: a block of level l has points s grid points of the finest
+  // level apart, i.e. s (n-1)/(M-1) points of the grid
+  const double scale = double(n_ - 1) / m;
+  std::function<void(int, int, int)> build = [&](int _l, int _bi, int _bj) {
+    const float g = steepness[_l][size_t(_bi << _l) + _bj];
+    if (_l < levels_ && g * std::max(1.0, stride(_l) * scale) > tolerance_)
+    {
+      nodes_[key(_l, _bi, _bj)] = INTERNAL;
+      for (int k = 0; k < 4; ++k)
+        build(_l + 1, 2 * _bi + k / 2, 2 * _bj + k % 2);
+    }
+    else
+    {
+      fill(new_block(_l, _bi, _bj), input);
+    }
+  };
+  build(0, 0, 0);
+
+  balance(input);
+  update_leaves();
+  fill_ghosts();
+}
+
+//-----------------------------------------------------------------------------
+
+void QuadtreeField::load(const HeatField& _field, int _i0, int _j0, int _i1,
+                         int _j1)
+{
+  if (empty() || _field.resolution() != n_)
+  {
+    load(_field);
+    return;
+  }
+
+  // points of the finest level whose interpolation touches the rectangle
+  const int m  = resolution_ - 1;
+  auto      lo = [&](int _i) {
+    return int(std::max<int64_t>(int64_t(_i - 1) * m / (n_ - 1), 0));
+  };
+  auto hi = [&](int _i) {
+    return int(std::min<int64_t>((int64_t(_i) * m + n_ - 2) / (n_ - 1), m));
+  };
+  const int Ia = lo(_i0), Ib = hi(_i1), Ja = lo(_j0), Jb = hi(_j1);
+
+  auto overlaps = [&](const Block& _bl) {
+    const int span = BLOCK * stride(_bl.level);
+    return _bl.bi * span <= Ib && Ia < (_bl.bi + 1) * span &&
+           _bl.bj * span <= Jb && Ja < (_bl.bj + 1) * span;
+  };
+
+  // refine the covering blocks to the finest level
+  const Sampler interpolate = [this](int _I, int _J) {
+    return value(_I, _J);
+  };
+  for (bool changed = true; changed;)
+  {
+    changed = false;
+    for (size_t b = 0; b < blocks_.size(); ++b)
+    {
+      const Block& bl = blocks_[b];
+      if (bl.level >= 0 && bl.level < levels_ && overlaps(bl))
+      {
+        refine(b, interpolate);
+        changed = true;
+      }
+    }
+  }
+  balance(interpolate);
+
+  // copy the values
+  for (size_t b = 0; b < blocks_.size(); ++b)
+  {
+    const Block& bl = blocks_[b];
+    if (bl.level < 0 || !overlaps(bl)) continue;
+
+    const int I0 = bl.bi * BLOCK, J0 = bl.bj * BLOCK;
+    float*    v  = values(b);
+    const int r1 = std::min(Ib - I0 + 1, int(BLOCK));
+    const int c1 = std::min(Jb - J0 + 1, int(BLOCK));
+    for (int r = std::max(Ia - I0, 0); r < r1; ++r)
+      for (int c = std::max(Ja - J0, 0); c < c1; ++c)
+        v[(r + 1) * PADDED + c + 1] = sample(_field, I0 + r, J0 + c);
+  }
+
+  update_leaves();
+  fill_ghosts();
+}
+
+//-----------------------------------------------------------------------------
+
+void QuadtreeField::store(HeatField& _field) const
+{
+  const int     n = n_, m = resolution_ - 1;
+  const int64_t N = n - 1;
+
+  // grid point i is at point i (M-1)/(n-1) of the finest level. Each leaf
+  // writes the interior grid points in its part of the square.
+  auto grid_range = [&](int _I0, int _I1, int& _begin, int& _end) {
+    _begin = std::max<int64_t>((_I0 * N + m - 1) / m, 1);
+    _end   = std::min<int64_t>((_I1 * N + m - 1) / m, n - 1);
+  };
+
+  for_leaves([&](int _b) {
+    const Block& bl = blocks_[_b];
+    const int    s  = stride(bl.level);
+    const int    I0 = bl.bi * BLOCK * s, J0 = bl.bj * BLOCK * s;
+    const float* v  = values(_b);
+
+    int i0, i1, j0, j1;
+    grid_range(I0, I0 + BLOCK * s, i0, i1);
+    grid_range(J0, J0 + BLOCK * s, j0, j1);
+
+    for (int i = i0; i < i1; ++i)
+    {
+      const double x  = double(i) * m / N;
+      const int    r  = std::min(int((x - I0) / s), BLOCK - 1);
+      const float  fr = (x - I0) / s - r;
+      const float* p  = v + (r + 1) * PADDED + 1;
+      const float* q  = p + PADDED;
+      float*       u  = _field.row(i);
+
+      for (int j = j0; j < j1; ++j)
+      {
+        const double y  = double(j) * m / N;
+        const int    c  = std::min(int((y - J0) / s), BLOCK - 1);
+        const float  fc = (y - J0) / s - c;
+        u[j] = (1.0f - fr) * ((1.0f - fc) * p[c] + fc * p[c + 1]) +
+               fr * ((1.0f - fc) * q[c] + fc * q[c + 1]);
+      }
+    }
+  });
+}
+
+//-----------------------------------------------------------------------------
+
+void QuadtreeField::lattice_lines(std::vector<float>& _xyz) const
+{
+  _xyz.clear();
+  _xyz.reserve(leaves_.size() * 2 * BLOCK * (BLOCK + 1) * 6);
+
+  const float h = 1.0f / (resolution_ - 1);
+  for (int b : leaves_)
+  {
+    const Block& bl = blocks_[b];
+    const int    s  = stride(bl.level);
+    const int    I0 = bl.bi * BLOCK * s, J0 = bl.bj * BLOCK * s;
+    const float* v  = values(b);
+
+    auto point = [&](int _r, int _c) {
+      _xyz.push_back((I0 + _r * s) * h);
+      _xyz.push_back((J0 + _c * s) * h);
+      _xyz.push_back(v[(_r + 1) * PADDED + _c + 1]);
+    };
+
+    for (int r = 0; r <= BLOCK; ++r)
+    {
+      for (int c = 0; c < BLOCK; ++c)
+      {
+        point(r, c);
+        point(r, c + 1);
+        point(c, r);
+        point(c + 1, r);
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void QuadtreeField::step(float _time_step, int _n_steps)
+{
+  if (empty()) return;
+
+  // the stencil of the finest level has M-1 instead of n-1 intervals
+  const double scale     = double(resolution_ - 1) / (n_ - 1);
+  const float  time_step = _time_step * scale * scale;
+
+  for (int k = 0; k < _n_steps; ++k)
+  {
+    if (++steps_ >= REGRID_INTERVAL)
+    {
+      regrid();
+      steps_ = 0;
+    }
+
+    // the finest leaves limit the time step; split it if it would be
+    // unstable there
+    const float limit = float(stride(finest_)) * stride(finest_);
+    const int   n_sub = std::max(1, int(std::ceil(time_step / limit - 1e-6f)));
+
+    for (int t = 0; t < n_sub; ++t)
+    {
+      for_leaves([&](int _b) { euler_block(_b, time_step / n_sub); });
+      current_ ^= 1;
+      fill_ghosts();
+    }
+  }
+}
+
+//=============================================================================
@@ -0,0 +1,251 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include "heat_field.h"
+#include "thread_team.h"
+
+//== CLASS DEFINITION =========================================================
+
+/// Adaptive version of the explicit Euler time stepping, on a quadtree of
+/// blocks.
+///
+/// Every block is a lattice of BLOCK x BLOCK grid points. A block of level
+/// l covers 1/2^l of the unit square in each direction, so its points are
+/// 2^(L-l) points of the finest level L apart. The finest level has
+/// BLOCK * 2^L + 1 points in each direction, at least as many as the
+/// uniform grid it is loaded from. Only the leaves of the quadtree store
+/// values, so the cost of a time step grows with the number of blocks
+/// that are needed to resolve the field, not with the area of the domain.
+///
+/// Blocks are refined where neighboring values differ by more than the
+/// tolerance, and groups of four are merged where they differ by less than
+/// a quarter of it. Neighboring leaves differ by at most one level. Each
+/// block has a layer of ghost values around it: copies from a neighbor of
+/// the same level, values of a finer neighbor at the same points, or
+/// values interpolated (bi)linearly from a coarser neighbor.
+///
+/// The stencil is the 5-point Laplacian of the explicit Euler step, scaled
+/// by the squared point distance of the block, with the same time step on
+/// all levels. The boundary values stay fixed. The blocks are distributed
+/// over the threads of a ThreadTeam.
+class QuadtreeField
+{
+public:
+
+    /// grid intervals (and points) per block side
+    static const int BLOCK = 16;
+
+    /// steps between two adaptations of the quadtree
+    static const int REGRID_INTERVAL = 8;
+
+    /// constructor, the work is split over the threads of _team (if given)
+    explicit QuadtreeField(ThreadTeam* _team = nullptr);
+
+    /// build the quadtree from the values of _field, refined where they
+    /// are steep
+    void load(const HeatField& _field);
+
+    /// refine the blocks covering the grid points [_i0, _i1) x [_j0, _j1)
+    /// of _field to the finest level, and copy their values from _field
+    void load(const HeatField& _field, int _i0, int _j0, int _i1, int _j1);
+
+    /// write the values to the interior grid points of _field (of the
+    /// resolution of the last load()), interpolated on coarse blocks
+    void store(HeatField& _field) const;
+
+    /// remove all blocks
+    void clear();
+
+    /// true if nothing is loaded
+    bool empty() const { return leaves_.empty(); }
+
+    /// _n_steps explicit Euler steps of size _time_step, for the point
+    /// distance of the grid of the last load()
+    void step(float _time_step, int _n_steps);
+
+    /// largest difference of neighboring values before a block is refined
+    float tolerance() const { return tolerance_; }
+
+    /// set the refinement tolerance
+    void set_tolerance(float _tolerance) { tolerance_ = _tolerance; }
+
+    /// number of leaf blocks
+    int n_blocks() const { return leaves_.size(); }
+
+    /// fraction of the points of the finest level that are simulated
+    double coverage() const;
+
+    /// the lattice lines of all blocks, two points (x, y, value) per line
+    /// segment, with (x, y) in the unit square
+    void lattice_lines(std::vector<float>& _xyz) const;
+
+private:
+
+    /// padded block side, including the ghost layer
+    static const int PADDED = BLOCK + 2;
+
+    /// values per block, including the ghost layer
+    static const int CELLS = PADDED * PADDED;
+
+    /// marks a node that has children
+    static const int INTERNAL = -1;
+
+    /// node (_level, _bi, _bj) of the quadtree
+    struct Block
+    {
+        int   level, bi, bj;
+        float steepness;
+    };
+
+    /// sampling function f(I, J) at points of the finest level
+    typedef std::function<float(int _I, int _J)> Sampler;
+
+    /// weight of a value in a ghost value: values_[current_][offset] for
+    /// offset >= 0, otherwise boundary_[-1 - offset]
+    struct Term
+    {
+        int   offset;
+        float weight;
+    };
+
+    /// ghost value at [index] of its block, the sum of terms_[first, last)
+    struct Ghost
+    {
+        int index, first, last;
+    };
+
+    /// hash key of node (_level, _bi, _bj)
+    static uint64_t key(int _level, int _bi, int _bj)
+    {
+        return (uint64_t(_level) << 58) | (uint64_t(_bi) << 29) |
+               uint64_t(_bj);
+    }
+
+    /// distance of the points of _level, in points of the finest level
+    int stride(int _level) const { return 1 << (levels_ - _level); }
+
+    /// values of block _b in the current (_buffer 0) or other buffer,
+    /// point (r, c) is at [(r + 1) * PADDED + c + 1], -1 <= r, c <= BLOCK
+    float* values(int _b, int _buffer = 0)
+    {
+        return values_[current_ ^ _buffer].data() + size_t(_b) * CELLS;
+    }
+    const float* values(int _b) const
+    {
+        return values_[current_].data() + size_t(_b) * CELLS;
+    }
+
+    /// leaf block containing point (_I, _J) of the finest level,
+    /// 0 <= _I, _J < resolution_ - 1
+    int find_leaf(int _I, int _J) const;
+
+    /// value at point (_I, _J) of the finest level, interpolated if it is
+    /// not a point of its leaf
+    float value(int _I, int _J) const;
+
+    /// append the terms of _weight * value(_I, _J) to _terms
+    void value_terms(int _I, int _J, float _weight,
+                     std::vector<Term>& _terms) const;
+
+    /// value of _field at point (_I, _J) of the finest level, bilinearly
+    /// interpolated
+    float sample(const HeatField& _field, int _I, int _J) const;
+
+    /// a leaf (_level, _bi, _bj) with uninitialized values
+    int new_block(int _level, int _bi, int _bj);
+
+    /// set the values of leaf _b to _f at its points
+    void fill(int _b, const Sampler& _f);
+
+    /// replace leaf _b by four children with values _f
+    void refine(int _b, const Sampler& _f);
+
+    /// true if the node next to leaf _b has leaves two levels finer
+    bool too_coarse(int _b) const;
+
+    /// refine leaves until neighbors differ by at most one level, new
+    /// values are taken from _f
+    void balance(const Sampler& _f);
+
+    /// replace the four leaf children of node (_level, _bi, _bj) by a leaf
+    /// if that keeps the quadtree balanced. Returns true on success.
+    bool coarsen(int _level, int _bi, int _bj);
+
+    /// refine steep blocks and coarsen flat ones
+    void regrid();
+
+    /// collect the leaves and their ghost sources after the quadtree has
+    /// changed
+    void update_leaves();
+
+    /// fill the ghost values of leaf _b
+    void fill_ghosts(int _b);
+
+    /// fill the ghost values of all leaves
+    void fill_ghosts();
+
+    /// explicit Euler step of leaf _b into the other buffer
+    void euler_block(int _b, float _time_step);
+
+    /// run _task(leaf) for all leaves, on the threads of the team
+    void for_leaves(const std::function<void(int _b)>& _task) const;
+
+private:
+
+    ThreadTeam* team_;
+
+    /// resolution of the loaded grid, and of the finest level
+    int n_, resolution_;
+
+    /// finest level L, and the finest level that has leaves
+    int levels_, finest_;
+
+    float tolerance_;
+
+    /// steps since the last adaptation of the quadtree
+    int steps_;
+
+    /// nodes by key: leaf block index or INTERNAL
+    std::unordered_map<uint64_t, int> nodes_;
+
+    /// blocks by index, level -1 for unused ones
+    std::vector<Block> blocks_;
+    std::vector<int>   free_blocks_;
+
+    /// indices of the leaf blocks
+    std::vector<int> leaves_;
+
+    /// leaf of the same level next to each side (-1, +1 rows, -1, +1
+    /// columns) of block b at [4 b + side], or -1
+    std::vector<int> neighbors_;
+
+    /// the other ghost values of block b are ghosts_[ghost_range_[2 b],
+    /// ghost_range_[2 b + 1]), with their terms
+    std::vector<int>   ghost_range_;
+    std::vector<Ghost> ghosts_;
+    std::vector<Term>  terms_;
+
+    /// values of all blocks, current and back buffer
+    std::vector<float> values_[2];
+    int                current_;
+
+    /// fixed boundary values of the last row (boundary_[J] at (M-1, J))
+    /// and of the last column (boundary_[M + I] at (I, M-1)) of the finest
+    /// level, with M = resolution_. They do not belong to any block.
+    std::vector<float> boundary_;
+};
+
+//=============================================================================
@@ -0,0 +1,224 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "rkl_integrator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+//== IMPLEMENTATION ==========================================================
+
+RKL_Integrator::RKL_Integrator(ThreadTeam* _team) : team_(_team), stages_(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+int RKL_Integrator::stages(float _time_step)
+{
+  // The Laplacian (sum of the neighbors - 4 u) / 4 has eigenvalues in
+  // (-2, 0], so explicit Euler is stable up to dt = 1. RKL2 with s stages
+  // is stable up to dt = (s^2 + s - 2) / 4.
+  const double s = 0.5 * (std::sqrt(9.0 + 16.0 * _time_step) - 1.0);
+  return std::max(2, int(std::ceil(s - 1e-9)));
+}
+
+//-----------------------------------------------------------------------------
+
+size_t RKL_Integrator::bytes(int _resolution)
+{
+  // three buffers with the row pitch of a HeatField
+  const int    line  = HeatField::FLOATS_PER_LINE;
+  const size_t pitch = (line + _resolution + 1 + line - 1) / line * line;
+  return 3 * size_t(_resolution) * pitch * sizeof(float);
+}
+
+//-----------------------------------------------------------------------------
+
+void RKL_Integrator::setup(int _stages)
+{
+  if (_stages == stages_) return;
+  stages_ = _stages;
+
+  const int s = _stages;
+
+  // b_j = (j^2 + j - 2) / (2 j (j + 1)), and b_0 = b_1 = b_2 = 1/3
+  auto b = [](int _j) {
+    return _j < 2 ? 1.0 / 3.0
+                  : double(_j * _j + _j - 2) / (2.0 * _j * (_j + 1));
+  };
+  const double w1 = 4.0 / (s * s + s - 2);
+
+  mu_.assign(s + 1, 0.0f);
+  nu_.assign(s + 1, 0.0f);
+  mu_tilde_.assign(s + 1, 0.0f);
+  gamma_tilde_.assign(s + 1, 0.0f);
+
+  mu_tilde_[1] = b(1) * w1;
+  for (int j = 2; j <= s; ++j)
+  {
+    const double mu = (2.0 * j - 1.0) / j * b(j) / b(j - 1);
+    mu_[j]          = mu;
+    nu_[j]          = -(j - 1.0) / j * b(j) / b(j - 2);
+    mu_tilde_[j]    = mu * w1;
+    gamma_tilde_[j] = -(1.0 - b(j - 1)) * mu * w1;
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+float* RKL_Integrator::stage_row(HeatField& _field, int _j, int _i)
+{
+  if (_j == 0) return _field.row(_i);
+  if (_j == stages_) return _field.back_row(_i);
+  return buffers_[_j % 3].data() + size_t(_i) * _field.pitch();
+}
+
+//-----------------------------------------------------------------------------
+
+void RKL_Integrator::copy_boundary(HeatField& _field)
+{
+  const int n     = _field.resolution();
+  const int bytes = (n + 2) * sizeof(float);
+
+  // back buffer, including the ghost cells
+  for (int i = -1; i <= n; ++i)
+  {
+    const float* in  = _field.row(i);
+    float*       out = _field.back_row(i);
+
+    if (i < 1 || i > n - 2)
+    {
+      memcpy(out - 1, in - 1, bytes);
+    }
+    else
+    {
+      out[-1]    = in[-1];
+      out[0]     = in[0];
+      out[n - 1] = in[n - 1];
+      out[n]     = in[n];
+    }
+  }
+
+  // intermediate stages, without ghost cells
+  for (int k = 0; k < 3; ++k)
+  {
+    buffers_[k].resize(size_t(n) * _field.pitch());
+    for (int i = 0; i < n; ++i)
+    {
+      const float* in  = _field.row(i);
+      float*       out = buffers_[k].data() + size_t(i) * _field.pitch();
+
+      if (i == 0 || i == n - 1)
+      {
+        memcpy(out, in, n * sizeof(float));
+      }
+      else
+      {
+        out[0]     = in[0];
+        out[n - 1] = in[n - 1];
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void RKL_Integrator::stage(HeatField& _field, int _j, float _time_step,
+                           int _begin, int _end)
+{
+  const int n = _field.resolution();
+
+  // dt L u = dt/4 (neighbor sum) - dt u
+  const float a = mu_tilde_[_j] * _time_step / 4.0f;
+
+  if (_j == 1)
+  {
+    // Y_1 = Y_0 + mu~_1 dt L Y_0
+    const float d = 1.0f - 4.0f * a;
+    for (int i = std::max(_begin, 1); i < std::min(_end, n - 1); ++i)
+    {
+      const float* HEAT_RESTRICT up   = _field.row(i - 1);
+      const float* HEAT_RESTRICT mid  = _field.row(i);
+      const float* HEAT_RESTRICT down = _field.row(i + 1);
+      float* HEAT_RESTRICT       out  = stage_row(_field, 1, i);
+
+      for (int j = 1; j < n - 1; ++j)
+        out[j] = d * mid[j] +
+                 a * ((up[j] + down[j]) + (mid[j - 1] + mid[j + 1]));
+    }
+    return;
+  }
+
+  // Y_j = (mu - 4a) Y_j-1 + a (neighbors of Y_j-1) + nu Y_j-2
+  //     + (1 - mu - nu - 4g) Y_0 + g (neighbors of Y_0)
+  const float mu = mu_[_j], nu = nu_[_j];
+  const float g  = gamma_tilde_[_j] * _time_step / 4.0f;
+  const float d1 = mu - 4.0f * a;
+  const float d0 = 1.0f - mu - nu - 4.0f * g;
+
+  for (int i = std::max(_begin, 1); i < std::min(_end, n - 1); ++i)
+  {
+    const float* HEAT_RESTRICT up    = stage_row(_field, _j - 1, i - 1);
+    const float* HEAT_RESTRICT mid   = stage_row(_field, _j - 1, i);
+    const float* HEAT_RESTRICT down  = stage_row(_field, _j - 1, i + 1);
+    const float* HEAT_RESTRICT prev  = stage_row(_field, _j - 2, i);
+    const float* HEAT_RESTRICT up0   = _field.row(i - 1);
+    const float* HEAT_RESTRICT mid0  = _field.row(i);
+    const float* HEAT_RESTRICT down0 = _field.row(i + 1);
+    float* HEAT_RESTRICT       out   = stage_row(_field, _j, i);
+
+    for (int j = 1; j < n - 1; ++j)
+      out[j] = d1 * mid[j] +
+               a * ((up[j] + down[j]) + (mid[j - 1] + mid[j + 1])) +
+               nu * prev[j] + d0 * mid0[j] +
+               g * ((up0[j] + down0[j]) + (mid0[j - 1] + mid0[j + 1]));
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void RKL_Integrator::step(HeatField& _field, float _time_step, int _n_steps)
+{
+  const int n = _field.resolution();
+  if (n < 3) return;
+
+  setup(stages(_time_step));
+
+  const int n_threads = team_ ? team_->size() : 1;
+
+  for (int k = 0; k < _n_steps; ++k)
+  {
+    copy_boundary(_field);
+
+    // every stage needs the neighbor rows of the previous one, so the
+    // threads synchronize after each stage
+    for (int j = 1; j <= stages_; ++j)
+    {
+      if (n_threads > 1)
+      {
+        team_->run([&](int _t) {
+          int begin, end;
+          ThreadTeam::band(0, n, n_threads, _t, begin, end);
+          stage(_field, j, _time_step, begin, end);
+        });
+      }
+      else
+      {
+        stage(_field, j, _time_step, 0, n);
+      }
+    }
+
+    _field.swap();
+  }
+}
+
+//=============================================================================
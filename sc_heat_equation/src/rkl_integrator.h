@@ -0,0 +1,82 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <vector>
+#include "heat_field.h"
+#include "thread_team.h"
+
+//== CLASS DEFINITION =========================================================
+
+/// Super-time-stepping with the second order Runge-Kutta-Legendre method
+/// (RKL2, Meyer, Balsara and Aslam 2014), for the same Laplacian L and
+/// fixed boundary values as the explicit Euler step.
+///
+/// A step of size dt consists of s stages, each of which is an explicit
+/// stencil sweep,
+///
+///     Y_1 = Y_0 + mu~_1 dt L Y_0,
+///     Y_j = mu_j Y_j-1 + nu_j Y_j-2 + (1 - mu_j - nu_j) Y_0
+///         + mu~_j dt L Y_j-1 + gamma~_j dt L Y_0,        j = 2..s,
+///
+/// with u' = Y_s. The stages are chosen such that the step is stable for
+/// dt up to (s^2 + s - 2)/4 times the explicit Euler limit. step() picks
+/// the smallest such s, so a large step costs O(sqrt(dt)) sweeps instead
+/// of O(dt) Euler steps. Each stage is distributed over the threads of a
+/// ThreadTeam in row bands.
+class RKL_Integrator
+{
+public:
+
+    /// constructor, the work is split over the threads of _team (if given)
+    explicit RKL_Integrator(ThreadTeam* _team = nullptr);
+
+    /// number of stages for a stable step of size _time_step
+    static int stages(float _time_step);
+
+    /// bytes of the stage buffers of step() for an _resolution^2 grid
+    static size_t bytes(int _resolution);
+
+    /// advance _field by _n_steps steps of size _time_step
+    void step(HeatField& _field, float _time_step, int _n_steps = 1);
+
+private:
+
+    /// compute the coefficients of the _stages stages
+    void setup(int _stages);
+
+    /// compute stage _j (1 <= _j <= s) for rows [_begin, _end)
+    void stage(HeatField& _field, int _j, float _time_step, int _begin,
+               int _end);
+
+    /// row _i of stage _j (0: the current values of _field, s: the back
+    /// buffer)
+    float* stage_row(HeatField& _field, int _j, int _i);
+
+    /// copy the fixed boundary values to the back buffer and the stages
+    void copy_boundary(HeatField& _field);
+
+private:
+
+    ThreadTeam* team_;
+
+    /// number of stages of the coefficients below
+    int stages_;
+
+    /// coefficients mu_j, nu_j, mu~_j and gamma~_j of stage j
+    std::vector<float> mu_, nu_, mu_tilde_, gamma_tilde_;
+
+    /// stages 1..s-1, in three buffers that are used in turn, with the
+    /// layout of the field (row i starts at i * pitch)
+    std::vector<float> buffers_[3];
+};
+
+//=============================================================================
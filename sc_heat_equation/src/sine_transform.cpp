@@ -0,0 +1,245 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "sine_transform.h"
+#include "heat_field.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+//== IMPLEMENTATION ==========================================================
+
+SineTransform::SineTransform()
+    : n_(0), length_(0), fft_size_(0), bluestein_(false)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+void SineTransform::resize(int _n)
+{
+  if (_n == n_) return;
+
+  n_      = _n;
+  length_ = 2 * (_n + 1);
+
+  // radix-2 if possible, otherwise a convolution of length >= 2L-1
+  int m = 1;
+  while (m < length_) m *= 2;
+  bluestein_ = (m != length_);
+  if (bluestein_)
+    while (m < 2 * length_ - 1) m *= 2;
+  fft_size_ = m;
+
+  int bits = 0;
+  while ((1 << bits) < m) ++bits;
+  bit_reverse_.resize(m);
+  for (int i = 0; i < m; ++i)
+  {
+    int r = 0;
+    for (int b = 0; b < bits; ++b)
+      if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+    bit_reverse_[i] = r;
+  }
+
+  twiddle_re_.resize(m / 2);
+  twiddle_im_.resize(m / 2);
+  for (int k = 0; k < m / 2; ++k)
+  {
+    const double phi = -2.0 * M_PI * k / m;
+    twiddle_re_[k]   = std::cos(phi);
+    twiddle_im_[k]   = std::sin(phi);
+  }
+
+  if (bluestein_)
+  {
+    const int L = length_;
+
+    // w_k = e^(-i pi k^2 / L), with k^2 reduced mod 2L for accuracy
+    chirp_re_.resize(L);
+    chirp_im_.resize(L);
+    for (int k = 0; k < L; ++k)
+    {
+      const double phi = -M_PI * double((int64_t(k) * k) % (2 * L)) / L;
+      chirp_re_[k]     = std::cos(phi);
+      chirp_im_[k]     = std::sin(phi);
+    }
+
+    // FFT of the conjugate chirp, wrapped around for negative indices. It
+    // is computed in all lanes, which is wasteful but only done once.
+    re_.assign(size_t(m) * LANES, 0.0f);
+    im_.assign(size_t(m) * LANES, 0.0f);
+    for (int k = 0; k < L; ++k)
+    {
+      for (int l = 0; l < LANES; ++l)
+      {
+        re_[size_t(k) * LANES + l] = chirp_re_[k];
+        im_[size_t(k) * LANES + l] = -chirp_im_[k];
+        if (k > 0)
+        {
+          re_[size_t(m - k) * LANES + l] = chirp_re_[k];
+          im_[size_t(m - k) * LANES + l] = -chirp_im_[k];
+        }
+      }
+    }
+    fft(re_.data(), im_.data(), false);
+
+    kernel_re_.resize(m);
+    kernel_im_.resize(m);
+    for (int k = 0; k < m; ++k)
+    {
+      kernel_re_[k] = re_[size_t(k) * LANES] / m;
+      kernel_im_[k] = im_[size_t(k) * LANES] / m;
+    }
+  }
+
+  re_.assign(size_t(m) * LANES, 0.0f);
+  im_.assign(size_t(m) * LANES, 0.0f);
+}
+
+//-----------------------------------------------------------------------------
+
+void SineTransform::fft(float* _re, float* _im, bool _inverse) const
+{
+  const int   m    = fft_size_;
+  const float sign = _inverse ? -1.0f : 1.0f;
+
+  // bit-reversal permutation of the lane vectors
+  for (int i = 0; i < m; ++i)
+  {
+    const int j = bit_reverse_[i];
+    if (i < j)
+    {
+      for (int l = 0; l < LANES; ++l)
+      {
+        std::swap(_re[size_t(i) * LANES + l], _re[size_t(j) * LANES + l]);
+        std::swap(_im[size_t(i) * LANES + l], _im[size_t(j) * LANES + l]);
+      }
+    }
+  }
+
+  // butterflies of span h, twiddle factors e^(-+ 2 pi i k / (2h))
+  for (int h = 1; h < m; h *= 2)
+  {
+    const int step = m / (2 * h);
+    for (int start = 0; start < m; start += 2 * h)
+    {
+      for (int k = 0; k < h; ++k)
+      {
+        const float wr = twiddle_re_[k * step];
+        const float wi = sign * twiddle_im_[k * step];
+
+        float* HEAT_RESTRICT xr = _re + size_t(start + k) * LANES;
+        float* HEAT_RESTRICT xi = _im + size_t(start + k) * LANES;
+        float* HEAT_RESTRICT yr = _re + size_t(start + k + h) * LANES;
+        float* HEAT_RESTRICT yi = _im + size_t(start + k + h) * LANES;
+
+        for (int l = 0; l < LANES; ++l)
+        {
+          const float tr = wr * yr[l] - wi * yi[l];
+          const float ti = wr * yi[l] + wi * yr[l];
+          yr[l]          = xr[l] - tr;
+          yi[l]          = xi[l] - ti;
+          xr[l] += tr;
+          xi[l] += ti;
+        }
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void SineTransform::transform(float* _a, float* _b)
+{
+  const int n = n_, L = length_, m = fft_size_;
+
+  float* HEAT_RESTRICT re = re_.data();
+  float* HEAT_RESTRICT im = im_.data();
+
+  // odd extension of a + i b, zero padded to the FFT length
+  std::fill(re_.begin(), re_.end(), 0.0f);
+  std::fill(im_.begin(), im_.end(), 0.0f);
+  for (int k = 1; k <= n; ++k)
+  {
+    const float* HEAT_RESTRICT a  = _a + size_t(k - 1) * LANES;
+    const float* HEAT_RESTRICT b  = _b + size_t(k - 1) * LANES;
+    float* HEAT_RESTRICT       r0 = re + size_t(k) * LANES;
+    float* HEAT_RESTRICT       i0 = im + size_t(k) * LANES;
+    float* HEAT_RESTRICT       r1 = re + size_t(L - k) * LANES;
+    float* HEAT_RESTRICT       i1 = im + size_t(L - k) * LANES;
+    for (int l = 0; l < LANES; ++l)
+    {
+      r0[l] = a[l];
+      i0[l] = b[l];
+      r1[l] = -a[l];
+      i1[l] = -b[l];
+    }
+  }
+
+  if (!bluestein_)
+  {
+    fft(re, im, false);
+  }
+  else
+  {
+    // DFT_p = w_p sum_k (y_k w_k) conj(w_(p-k)), a cyclic convolution
+    auto chirp = [&](int _count) {
+      for (int k = 0; k < _count; ++k)
+      {
+        const float wr = chirp_re_[k], wi = chirp_im_[k];
+        float* HEAT_RESTRICT r = re + size_t(k) * LANES;
+        float* HEAT_RESTRICT i = im + size_t(k) * LANES;
+        for (int l = 0; l < LANES; ++l)
+        {
+          const float x = r[l], y = i[l];
+          r[l]          = wr * x - wi * y;
+          i[l]          = wr * y + wi * x;
+        }
+      }
+    };
+
+    chirp(L);
+    fft(re, im, false);
+    for (int k = 0; k < m; ++k)
+    {
+      const float wr = kernel_re_[k], wi = kernel_im_[k];
+      float* HEAT_RESTRICT r = re + size_t(k) * LANES;
+      float* HEAT_RESTRICT i = im + size_t(k) * LANES;
+      for (int l = 0; l < LANES; ++l)
+      {
+        const float x = r[l], y = i[l];
+        r[l]          = wr * x - wi * y;
+        i[l]          = wr * y + wi * x;
+      }
+    }
+    fft(re, im, true);
+    chirp(L);
+  }
+
+  // DFT(odd extension of x) = -2i DST(x), so with z = a + i b:
+  // Re DFT(z) = 2 DST(b), Im DFT(z) = -2 DST(a)
+  for (int p = 1; p <= n; ++p)
+  {
+    const float* HEAT_RESTRICT r = re + size_t(p) * LANES;
+    const float* HEAT_RESTRICT i = im + size_t(p) * LANES;
+    float* HEAT_RESTRICT       a = _a + size_t(p - 1) * LANES;
+    float* HEAT_RESTRICT       b = _b + size_t(p - 1) * LANES;
+    for (int l = 0; l < LANES; ++l)
+    {
+      a[l] = -0.5f * i[l];
+      b[l] = 0.5f * r[l];
+    }
+  }
+}
+
+//=============================================================================
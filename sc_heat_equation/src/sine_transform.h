@@ -0,0 +1,79 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <vector>
+
+//== CLASS DEFINITION =========================================================
+
+/// Fast discrete sine transform (DST-I) of several signals at once,
+///
+///     X_p = sum_{k=1..n} x_k sin(pi p k / (n+1)),   p = 1..n.
+///
+/// Applying it twice gives (n+1)/2 times the input. The DST-I of x is,
+/// up to a factor of -2i, the discrete Fourier transform of its odd
+/// extension (0, x_1..x_n, 0, -x_n..-x_1) of length L = 2(n+1). Two sets of
+/// signals are transformed with one complex FFT, one in the real and one
+/// in the imaginary part, as their DFTs are purely imaginary.
+///
+/// The FFT is radix-2 if L is a power of two, and otherwise Bluestein's
+/// chirp-z algorithm, which turns the DFT into a convolution that is
+/// computed with power-of-two FFTs. Every operation is done for LANES
+/// signals at once, with the signals interleaved element by element, so
+/// the inner loops run over contiguous lanes and vectorize.
+class SineTransform
+{
+public:
+
+    /// number of signals in each of the two sets
+    static const int LANES = 16;
+
+    /// constructor
+    SineTransform();
+
+    /// prepare for signals of length _n
+    void resize(int _n);
+
+    /// length of the signals
+    int size() const { return n_; }
+
+    /// replace the signals in _a and _b by their DST-I. Element k of
+    /// signal l is at [k * LANES + l], 0 <= k < size().
+    void transform(float* _a, float* _b);
+
+private:
+
+    /// in-place radix-2 FFT of LANES complex signals of length fft_size_,
+    /// with e^(+i...) if _inverse is set (not scaled)
+    void fft(float* _re, float* _im, bool _inverse) const;
+
+private:
+
+    /// signal length, DFT length 2(n+1), and FFT length
+    int n_, length_, fft_size_;
+
+    /// is the DFT computed by Bluestein's algorithm?
+    bool bluestein_;
+
+    /// bit-reversed indices and twiddle factors e^(-2 pi i k / fft_size_)
+    std::vector<int>   bit_reverse_;
+    std::vector<float> twiddle_re_, twiddle_im_;
+
+    /// Bluestein: chirp e^(-i pi k^2 / L) and the FFT of its conjugate,
+    /// divided by fft_size_
+    std::vector<float> chirp_re_, chirp_im_;
+    std::vector<float> kernel_re_, kernel_im_;
+
+    /// work space, fft_size_ complex elements per lane
+    std::vector<float> re_, im_;
+};
+
+//=============================================================================
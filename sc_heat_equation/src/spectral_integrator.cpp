@@ -0,0 +1,186 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "spectral_integrator.h"
+
+#include <algorithm>
+#include <cmath>
+
+//== IMPLEMENTATION ==========================================================
+
+SpectralIntegrator::SpectralIntegrator(ThreadTeam* _team)
+    : team_(_team), m_(0)
+{
+  const int n_threads = team_ ? team_->size() : 1;
+  transforms_.resize(n_threads);
+  strips_.resize(n_threads);
+}
+
+//-----------------------------------------------------------------------------
+
+void SpectralIntegrator::setup(int _resolution)
+{
+  const int m = _resolution - 2;
+  if (m == m_) return;
+  m_ = m;
+
+  // L0 is (shift up + shift down - 2 I)/4 along each direction, with
+  // eigenvalues -sin^2(pi p / (2(m+1)))
+  eigenvalues_.resize(m + 1);
+  for (int p = 1; p <= m; ++p)
+  {
+    const double s  = std::sin(M_PI * p / (2.0 * (m + 1)));
+    eigenvalues_[p] = s * s;
+  }
+
+  u_.assign(size_t(m) * m, 0.0f);
+  b_.assign(size_t(m) * m, 0.0f);
+
+  for (size_t t = 0; t < transforms_.size(); ++t)
+  {
+    transforms_[t].resize(m);
+    strips_[t].resize(size_t(2) * m * SineTransform::LANES);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void SpectralIntegrator::transform_strip(float* const* _signals, int _stride,
+                                         int _thread)
+{
+  const int m = m_, L = SineTransform::LANES;
+  float*    a = strips_[_thread].data();
+  float*    b = a + size_t(m) * L;
+
+  // gather, element k of signal l at [k * L + l]
+  for (int l = 0; l < 2 * L; ++l)
+  {
+    float*       strip = (l < L ? a + l : b + (l - L));
+    const float* x     = _signals[l];
+    if (x)
+      for (int k = 0; k < m; ++k) strip[size_t(k) * L] = x[size_t(k) * _stride];
+    else
+      for (int k = 0; k < m; ++k) strip[size_t(k) * L] = 0.0f;
+  }
+
+  transforms_[_thread].transform(a, b);
+
+  // scatter
+  for (int l = 0; l < 2 * L; ++l)
+  {
+    const float* strip = (l < L ? a + l : b + (l - L));
+    float*       x     = _signals[l];
+    if (x)
+      for (int k = 0; k < m; ++k) x[size_t(k) * _stride] = strip[size_t(k) * L];
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void SpectralIntegrator::transform(bool _both)
+{
+  const int m = m_, L = SineTransform::LANES;
+
+  // signals per strip: L rows (columns) of u and the same ones of b, or
+  // 2L rows (columns) of u
+  const int per_strip = _both ? L : 2 * L;
+  const int n_strips  = (m + per_strip - 1) / per_strip;
+
+  auto pass = [&](bool _rows, int _thread, int _n_threads) {
+    float* signals[2 * L];
+    for (int s = _thread; s < n_strips; s += _n_threads)
+    {
+      for (int l = 0; l < 2 * L; ++l)
+      {
+        // index of the row (column) and its array
+        const int   k     = s * per_strip + (_both ? l % L : l);
+        float*      array = (_both && l >= L) ? b_.data() : u_.data();
+        const size_t first = _rows ? size_t(k) * m : size_t(k);
+        signals[l]         = (k < m) ? array + first : nullptr;
+      }
+      transform_strip(signals, _rows ? 1 : m, _thread);
+    }
+  };
+
+  // rows, then columns; each pass has to be complete before the next
+  for (int rows = 1; rows >= 0; --rows)
+  {
+    if (team_ && team_->size() > 1)
+      team_->run([&](int _t) { pass(rows == 1, _t, team_->size()); });
+    else
+      pass(rows == 1, 0, 1);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void SpectralIntegrator::step(HeatField& _field, float _time_step,
+                              int _n_steps)
+{
+  const int n = _field.resolution();
+  if (n < 3) return;
+
+  setup(n);
+
+  const int    m = m_;
+  const double t = double(_time_step) * _n_steps;
+  int          i, j;
+
+  // interior values, and the boundary values that their neighbors
+  // contribute to L u
+  for (i = 1; i <= m; ++i)
+  {
+    const float* up   = _field.row(i - 1);
+    const float* mid  = _field.row(i);
+    const float* down = _field.row(i + 1);
+    float*       u    = &u_[size_t(i - 1) * m] - 1;
+    float*       b    = &b_[size_t(i - 1) * m] - 1;
+
+    for (j = 1; j <= m; ++j)
+    {
+      u[j] = mid[j];
+      b[j] = 0.0f;
+    }
+    b[1] += 0.25f * mid[0];
+    b[m] += 0.25f * mid[m + 1];
+    if (i == 1)
+      for (j = 1; j <= m; ++j) b[j] += 0.25f * up[j];
+    if (i == m)
+      for (j = 1; j <= m; ++j) b[j] += 0.25f * down[j];
+  }
+
+  transform(true);
+
+  // u' = v + exp(t L0) (u - v) with v = -b / lambda, per coefficient,
+  // including the factor (2/(m+1))^2 of the inverse transform
+  const double scale = 4.0 / (double(m + 1) * (m + 1));
+  for (int p = 1; p <= m; ++p)
+  {
+    float* u = &u_[size_t(p - 1) * m] - 1;
+    float* b = &b_[size_t(p - 1) * m] - 1;
+    for (int q = 1; q <= m; ++q)
+    {
+      const double lambda = -(eigenvalues_[p] + eigenvalues_[q]);
+      const double e      = std::expm1(lambda * t);
+      u[q] = scale * ((1.0 + e) * u[q] + e / lambda * b[q]);
+    }
+  }
+
+  transform(false);
+
+  for (i = 1; i <= m; ++i)
+  {
+    const float* u   = &u_[size_t(i - 1) * m] - 1;
+    float*       out = _field.row(i);
+    for (j = 1; j <= m; ++j) out[j] = u[j];
+  }
+}
+
+//=============================================================================
@@ -0,0 +1,80 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <vector>
+#include "heat_field.h"
+#include "sine_transform.h"
+#include "thread_team.h"
+
+//== CLASS DEFINITION =========================================================
+
+/// Exact time integration of the heat equation du/dt = L u, with the same
+/// Laplacian and fixed boundary values as the explicit Euler step.
+///
+/// With the boundary values moved to the right hand side, the equation
+/// for the interior values is du/dt = L0 u + b, where L0 is the Laplacian
+/// with zero boundary values. The 2D sine transform diagonalizes L0, with
+/// eigenvalues lambda_pq < 0, so the solution after time t is
+///
+///     u(t) = v + exp(t L0) (u(0) - v),
+///
+/// with v = -L0^-1 b the equilibrium. In the sine basis both the
+/// equilibrium and the exponential are a division or multiplication per
+/// coefficient. A step of any length therefore takes three 2D transforms,
+/// O(N^2 log N), and has no time discretization error.
+///
+/// The 1D transforms along the rows and columns are done in strips of
+/// rows or columns, which are distributed over the threads of a
+/// ThreadTeam.
+class SpectralIntegrator
+{
+public:
+
+    /// constructor, the work is split over the threads of _team (if given)
+    explicit SpectralIntegrator(ThreadTeam* _team = nullptr);
+
+    /// advance _field by _n_steps steps of size _time_step, i.e. by time
+    /// _n_steps * _time_step at once
+    void step(HeatField& _field, float _time_step, int _n_steps = 1);
+
+private:
+
+    /// prepare for an N x N grid
+    void setup(int _resolution);
+
+    /// 2D sine transform of the interior values u_ and, if _both is set,
+    /// of b_
+    void transform(bool _both);
+
+    /// 1D transforms of the signals _signals[0..2*LANES-1] (nullptr: none)
+    /// with element distance _stride, with the transform of _thread
+    void transform_strip(float* const* _signals, int _stride, int _thread);
+
+private:
+
+    ThreadTeam* team_;
+
+    /// number of interior points in each direction
+    int m_;
+
+    /// sin^2(pi p / (2(m+1))), minus the eigenvalues of the 1D Laplacian
+    std::vector<double> eigenvalues_;
+
+    /// interior values and boundary terms, m x m, row by row
+    std::vector<float> u_, b_;
+
+    /// transform and its gathered signals, one per thread
+    std::vector<SineTransform>      transforms_;
+    std::vector<std::vector<float>> strips_;
+};
+
+//=============================================================================
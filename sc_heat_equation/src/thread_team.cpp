@@ -0,0 +1,101 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "thread_team.h"
+
+#include <algorithm>
+
+//== IMPLEMENTATION ==========================================================
+
+ThreadTeam::ThreadTeam(unsigned int _n_threads)
+    : task_(nullptr), generation_(0), running_(0), stop_(false)
+{
+  if (_n_threads == 0)
+    _n_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  for (unsigned int t = 1; t < _n_threads; ++t)
+    threads_.push_back(std::thread(&ThreadTeam::work, this, int(t)));
+}
+
+//-----------------------------------------------------------------------------
+
+ThreadTeam::~ThreadTeam()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  start_.notify_all();
+
+  for (std::thread& thread : threads_) thread.join();
+}
+
+//-----------------------------------------------------------------------------
+
+void ThreadTeam::run(const std::function<void(int)>& _task)
+{
+  if (threads_.empty())
+  {
+    _task(0);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_    = &_task;
+    running_ = threads_.size();
+    ++generation_;
+  }
+  start_.notify_all();
+
+  _task(0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this]() { return running_ == 0; });
+  task_ = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+
+void ThreadTeam::band(int _first, int _last, int _n_bands, int _thread,
+                      int& _begin, int& _end)
+{
+  const long n = _last - _first;
+  _begin       = _first + int(n * _thread / _n_bands);
+  _end         = _first + int(n * (_thread + 1) / _n_bands);
+}
+
+//-----------------------------------------------------------------------------
+
+void ThreadTeam::work(int _thread)
+{
+  unsigned long generation = 0;
+
+  for (;;)
+  {
+    const std::function<void(int)>* task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_.wait(lock, [&]() { return stop_ || generation_ != generation; });
+      if (stop_) return;
+      generation = generation_;
+      task       = task_;
+    }
+
+    (*task)(_thread);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--running_ == 0) done_.notify_one();
+    }
+  }
+}
+
+//=============================================================================
@@ -0,0 +1,63 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//== CLASS DEFINITION =========================================================
+
+/// Persistent team of threads that run the same function in parallel, each
+/// with its own thread index. Index 0 is the calling thread, index t > 0 is
+/// always executed by the same worker thread, so data a thread touches
+/// first in one run() stays local to it in later runs.
+class ThreadTeam
+{
+public:
+
+    /// team of _n_threads threads including the caller (0: one per
+    /// hardware thread)
+    explicit ThreadTeam(unsigned int _n_threads = 0);
+
+    /// destructor, joins the worker threads
+    ~ThreadTeam();
+
+    /// number of threads, including the caller
+    int size() const { return threads_.size() + 1; }
+
+    /// run _task(t) for t = 0, ..., size()-1 in parallel and wait for all
+    void run(const std::function<void(int _thread)>& _task);
+
+    /// rows [_begin, _end) of thread _thread when [_first, _last) is split
+    /// into _n_bands contiguous bands of (almost) equal size
+    static void band(int _first, int _last, int _n_bands, int _thread,
+                     int& _begin, int& _end);
+
+private:
+
+    /// main loop of worker thread _thread
+    void work(int _thread);
+
+private:
+
+    std::vector<std::thread>        threads_;
+    std::mutex                      mutex_;
+    std::condition_variable         start_, done_;
+    const std::function<void(int)>* task_;
+    unsigned long                   generation_;
+    int                             running_;
+    bool                            stop_;
+};
+
+//=============================================================================
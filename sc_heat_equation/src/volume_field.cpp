@@ -0,0 +1,212 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "volume_field.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+//== IMPLEMENTATION ==========================================================
+
+VolumeField::VolumeField(ThreadTeam* _team)
+    : team_(_team),
+      resolution_(0),
+      pitch_(0),
+      plane_pitch_(0),
+      tile_rows_(0),
+      current_(nullptr),
+      next_(nullptr)
+{
+  if (team_) progress_.reset(new Progress[team_->size()]);
+}
+
+//-----------------------------------------------------------------------------
+
+void VolumeField::resize(int _resolution)
+{
+  resolution_ = _resolution;
+
+  // rows of full cache lines, and one line of padding after each plane
+  const int line = FLOATS_PER_LINE;
+  pitch_         = (_resolution + line - 1) / line * line;
+  plane_pitch_   = size_t(_resolution) * pitch_ + line;
+
+  // two buffers of N planes each, plus slack for the alignment. The memory
+  // is not initialized here, but by the thread that owns the planes.
+  const size_t buffer_size = size_t(_resolution) * plane_pitch_;
+  storage_.reset(new float[2 * buffer_size + line]);
+
+  float* base = storage_.get();
+  while (reinterpret_cast<uintptr_t>(base) % ALIGNMENT) ++base;
+  current_ = base;
+  next_    = base + buffer_size;
+
+  // each thread clears the planes it will update in explicit_euler_steps()
+  const int n_slabs = team_ ? std::min(team_->size(), _resolution) : 1;
+  auto      clear   = [&](int _thread) {
+    if (_thread >= n_slabs) return;
+    int begin, end;
+    ThreadTeam::band(0, _resolution, n_slabs, _thread, begin, end);
+    const size_t offset = size_t(begin) * plane_pitch_;
+    const size_t bytes  = size_t(end - begin) * plane_pitch_ * sizeof(float);
+    memset(current_ + offset, 0, bytes);
+    memset(next_ + offset, 0, bytes);
+  };
+
+  if (n_slabs > 1)
+    team_->run(clear);
+  else
+    clear(0);
+}
+
+//-----------------------------------------------------------------------------
+
+int VolumeField::tile_rows() const
+{
+  if (tile_rows_ > 0) return tile_rows_;
+
+  // three planes of the tile, including the rows above and below it
+  const int rows = TILE_CACHE_BYTES / (3 * pitch_ * int(sizeof(float))) - 2;
+  return std::max(rows, 4);
+}
+
+//-----------------------------------------------------------------------------
+
+void VolumeField::copy_boundary(const float* _in, float* _out, int _begin,
+                                int _end) const
+{
+  const int n = resolution_;
+
+  for (int k = _begin; k < _end; ++k)
+  {
+    // the first and last plane stay fixed as a whole
+    if (k == 0 || k == n - 1)
+    {
+      memcpy(_out + index(0, 0, k), _in + index(0, 0, k),
+             plane_pitch_ * sizeof(float));
+      continue;
+    }
+
+    // in the others, the first and last row and column
+    memcpy(_out + index(0, 0, k), _in + index(0, 0, k), n * sizeof(float));
+    memcpy(_out + index(n - 1, 0, k), _in + index(n - 1, 0, k),
+           n * sizeof(float));
+    for (int i = 1; i < n - 1; ++i)
+    {
+      _out[index(i, 0, k)]     = _in[index(i, 0, k)];
+      _out[index(i, n - 1, k)] = _in[index(i, n - 1, k)];
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+/// one step for _count consecutive values of a row, given its four
+/// neighbor rows in the same plane and the planes below and above. The
+/// loop is branch-free and vectorized by the compiler.
+static inline void volume_kernel(const float* HEAT_RESTRICT _below,
+                                 const float* HEAT_RESTRICT _up,
+                                 const float* HEAT_RESTRICT _mid,
+                                 const float* HEAT_RESTRICT _down,
+                                 const float* HEAT_RESTRICT _above,
+                                 float* HEAT_RESTRICT _out, int _count,
+                                 float _c, float _d)
+{
+  for (int j = 0; j < _count; ++j)
+    _out[j] = _d * _mid[j] +
+              _c * (((_up[j] + _down[j]) + (_mid[j - 1] + _mid[j + 1])) +
+                    (_below[j] + _above[j]));
+}
+
+//-----------------------------------------------------------------------------
+
+void VolumeField::euler_planes(const float* _in, float* _out, int _begin,
+                               int _end, float _time_step) const
+{
+  // U += dt * (sum of the 6 neighbors - 6 U) / h, with h = 2*2
+  const int   n = resolution_;
+  const float c = _time_step / 4.0f;
+  const float d = 1.0f - 6.0f * c;
+
+  copy_boundary(_in, _out, _begin, _end);
+
+  const int k0 = std::max(_begin, 1), k1 = std::min(_end, n - 1);
+  const int rows = tile_rows();
+
+  // 2.5D blocking: a tile of rows is streamed through the planes of the
+  // slab, its planes k and k+1 are reused from the cache for plane k+1
+  for (int i0 = 1; i0 < n - 1; i0 += rows)
+  {
+    const int i1 = std::min(i0 + rows, n - 1);
+    for (int k = k0; k < k1; ++k)
+      for (int i = i0; i < i1; ++i)
+        volume_kernel(_in + index(i, 1, k - 1), _in + index(i - 1, 1, k),
+                      _in + index(i, 1, k), _in + index(i + 1, 1, k),
+                      _in + index(i, 1, k + 1), _out + index(i, 1, k), n - 2,
+                      c, d);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void VolumeField::explicit_euler_steps(float _time_step, int _n_steps)
+{
+  const int n = resolution_;
+  if (n < 3) return;
+
+  // serial: one sweep over all planes per step
+  const int n_slabs = team_ ? std::min(team_->size(), n) : 1;
+  if (n_slabs == 1)
+  {
+    for (int s = 0; s < _n_steps; ++s)
+    {
+      euler_planes(current_, next_, 0, n, _time_step);
+      swap();
+    }
+    return;
+  }
+
+  // parallel: slab b computes step s from buffer s%2 into buffer (s+1)%2.
+  // It reads the last plane of slab b-1 and the first plane of slab b+1,
+  // and its output overwrites what they read in step s-1. Both are safe
+  // once the two neighbors have completed s steps.
+  for (int b = 0; b < n_slabs; ++b)
+    progress_[b].steps.store(0, std::memory_order_relaxed);
+
+  float* buffers[2] = {current_, next_};
+
+  team_->run([&](int _thread) {
+    if (_thread >= n_slabs) return;
+
+    int begin, end;
+    ThreadTeam::band(0, n, n_slabs, _thread, begin, end);
+
+    std::atomic<int>* left =
+        _thread > 0 ? &progress_[_thread - 1].steps : nullptr;
+    std::atomic<int>* right =
+        _thread + 1 < n_slabs ? &progress_[_thread + 1].steps : nullptr;
+
+    for (int s = 0; s < _n_steps; ++s)
+    {
+      while ((left && left->load(std::memory_order_acquire) < s) ||
+             (right && right->load(std::memory_order_acquire) < s))
+        std::this_thread::yield();
+
+      euler_planes(buffers[s % 2], buffers[(s + 1) % 2], begin, end,
+                   _time_step);
+      progress_[_thread].steps.store(s + 1, std::memory_order_release);
+    }
+  });
+
+  if (_n_steps % 2) swap();
+}
+
+//=============================================================================
@@ -0,0 +1,145 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+#pragma once
+//=============================================================================
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include "heat_field.h"
+#include "thread_team.h"
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Scalar field on an N x N x N grid, double-buffered for time stepping.
+///
+/// Value (i,j,k) is column j of row i of plane k. Rows are stored like in
+/// HeatField: each starts at a 64 byte boundary and its pitch is a multiple
+/// of 16 floats. Planes are one cache line longer than their rows, so
+/// neighboring planes do not map to the same cache sets when the row length
+/// is a power of two. There are no ghost cells, the boundary values stay
+/// fixed.
+///
+/// With a ThreadTeam the planes are split into one slab per thread, which
+/// each thread initializes (first touches) and updates.
+///
+/// The 7-point stencil reads three planes at a time. Planes of a large grid
+/// do not fit into the cache, so the stencil is blocked in 2.5D: each slab
+/// is cut into tiles of rows, and a tile is streamed through the slab plane
+/// by plane. Planes k and k+1 of the tile are still in cache when plane
+/// k+1 is computed, so every value is loaded from memory only once per
+/// step.
+class VolumeField
+{
+public:
+
+    /// row alignment in bytes
+    static const int ALIGNMENT = HeatField::ALIGNMENT;
+
+    /// floats per alignment unit, the pitch is a multiple of it
+    static const int FLOATS_PER_LINE = ALIGNMENT / sizeof(float);
+
+    /// cache budget of the three planes of a tile
+    static const int TILE_CACHE_BYTES = 256 * 1024;
+
+    /// empty field, which is processed by the threads of _team (if given)
+    explicit VolumeField(ThreadTeam* _team = nullptr);
+
+    /// resize to _resolution^3 values, all set to zero
+    void resize(int _resolution);
+
+    /// number of grid points in each direction
+    int resolution() const { return resolution_; }
+
+    /// read-write access to the current value at grid point (i,j,k)
+    float& operator()(int _i, int _j, int _k)
+    {
+        return current_[index(_i, _j, _k)];
+    }
+
+    /// read-only access to the current value at grid point (i,j,k)
+    float operator()(int _i, int _j, int _k) const
+    {
+        return current_[index(_i, _j, _k)];
+    }
+
+    /// row _i of plane _k, row(_i, _k)[_j] is value (_i,_j,_k)
+    float* row(int _i, int _k) { return current_ + index(_i, 0, _k); }
+    const float* row(int _i, int _k) const
+    {
+        return current_ + index(_i, 0, _k);
+    }
+
+    /// _n_steps explicit Euler steps of the heat equation with grid spacing
+    /// 2, boundary values stay fixed. The 7-point Laplacian has a diagonal
+    /// of -6/4, so steps are stable up to a time step of 2/3.
+    ///
+    /// The slabs do not wait for each other between steps: a slab only
+    /// waits until its two neighbor slabs have finished the previous step.
+    void explicit_euler_steps(float _time_step, int _n_steps);
+
+    /// rows per tile of the 2.5D blocking
+    int tile_rows() const;
+
+    /// set the rows per tile (0: as many as fit into TILE_CACHE_BYTES)
+    void set_tile_rows(int _rows) { tile_rows_ = std::max(0, _rows); }
+
+    /// swap current and back buffer
+    void swap() { std::swap(current_, next_); }
+
+private:
+
+    /// update planes [_begin, _end) of _out from _in
+    void euler_planes(const float* _in, float* _out, int _begin, int _end,
+                      float _time_step) const;
+
+    /// copy the boundary values of planes [_begin, _end) from _in to _out
+    void copy_boundary(const float* _in, float* _out, int _begin,
+                       int _end) const;
+
+    /// position of value (i,j,k) in a buffer
+    size_t index(int _i, int _j, int _k) const
+    {
+        return size_t(_k) * plane_pitch_ + size_t(_i) * pitch_ + _j;
+    }
+
+private:
+
+    /// steps completed by a slab, one per cache line
+    struct Progress
+    {
+        std::atomic<int> steps;
+        char             padding[ALIGNMENT - sizeof(std::atomic<int>)];
+    };
+
+    ThreadTeam* team_;
+
+    int resolution_, pitch_;
+
+    /// floats between two planes
+    size_t plane_pitch_;
+
+    /// rows per tile, 0: automatic
+    int tile_rows_;
+
+    /// storage of both buffers, over-allocated for alignment and left
+    /// uninitialized until each thread touches its slab
+    std::unique_ptr<float[]> storage_;
+
+    /// progress of the slabs in explicit_euler_steps(), one per thread
+    std::unique_ptr<Progress[]> progress_;
+
+    /// current values and back buffer, aligned pointers into storage_
+    float *current_, *next_;
+};
+
+
+//=============================================================================
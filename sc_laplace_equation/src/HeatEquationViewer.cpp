@@ -294,6 +294,7 @@ void HeatEquationViewer::processImGUI()
         ImGui::RadioButton("Eigen's Cholesky", &solver, 0);
         ImGui::RadioButton("Our Gradient Descent", &solver, 1);
         ImGui::RadioButton("Our Conjugate Gradients", &solver, 2);
+        ImGui::RadioButton("Our Multigrid", &solver, 3);
         if (solver != solver_)
         {
             solver_ = (Solver)solver;
@@ -608,6 +609,12 @@ void HeatEquationViewer::solve_equilibrium()
             solve_cg();
             break;
         }
+
+        case MULTIGRID:
+        {
+            solve_mg();
+            break;
+        }
     }
 }
 
@@ -770,4 +777,44 @@ void HeatEquationViewer::solve_cg()
               << (err < 1e-10 ? "ok\n" : "TOO HIGH\n");
 }
 
+//-----------------------------------------------------------------------------
+
+void HeatEquationViewer::solve_mg()
+{
+    Timer timer;
+    timer.start();
+
+    const int r = grid_resolution_;
+    int i, j;
+
+    // the hierarchy only depends on the resolution
+    if (multigrid_.resolution() != r) multigrid_.resize(r);
+
+    // boundary values and initial guess from the grid, no heat sources
+    for (i = 0; i < r; ++i)
+    {
+        for (j = 0; j < r; ++j)
+        {
+            multigrid_.u(i, j) = U(i, j);
+            multigrid_.f(i, j) = 0.0;
+        }
+    }
+
+    // V-cycles up to error 1e-10, their number does not depend on r
+    const int cycles = multigrid_.solve(1e-10, 50);
+
+    // copy solution to grid U(i,j)
+    for (i = 1; i < r - 1; ++i)
+        for (j = 1; j < r - 1; ++j) U(i, j) = multigrid_.u(i, j);
+
+    // output timing & error
+    timer.stop();
+    std::cout << "Multigrid:\n";
+    std::cout << "  time:   " << timer << std::endl;
+    std::cout << "  cycles: " << cycles << std::endl;
+    Scalar err = multigrid_.residual();
+    std::cout << "  error:  " << err << " --> "
+              << (err < 1e-10 ? "ok\n" : "TOO HIGH\n");
+}
+
 //=============================================================================
@@ -15,6 +15,7 @@
 
 #include <vector>
 #include "types.h"
+#include "multigrid.h"
 #include "sparse_matrix.h"
 
 using namespace pmp;
@@ -111,6 +112,9 @@ protected:
     /// solve by our conjugate gradients solver
     void solve_cg();
 
+    /// solve by our geometric multigrid solver
+    void solve_mg();
+
 protected:
 
     /// grid resolution
@@ -150,8 +154,12 @@ protected:
     {
         CHOLESKY_EIGEN=0,
         GRADIENT_DESCENT=1,
-        CONJUGATE_GRADIENTS=2
+        CONJUGATE_GRADIENTS=2,
+        MULTIGRID=3
     } solver_;
+
+    /// multigrid hierarchy, kept as long as the resolution does not change
+    Multigrid multigrid_;
 };
 
 //=============================================================================
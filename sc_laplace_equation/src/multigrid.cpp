@@ -0,0 +1,373 @@
+//=============================================================================
+//
+//   Exercise code for the lecture
+//   "Scientific Computing"
+//   by Prof. Dr. Mario Botsch, Bielefeld University
+//
+//   Copyright (C) 2018  Computer Graphics Group, Bielefeld University.
+//
+//=============================================================================
+
+#include "multigrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+//== IMPLEMENTATION ==========================================================
+
+Multigrid::Multigrid() : pre_smoothing(2), post_smoothing(2), residual_(0.0)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+void Multigrid::resize(int _resolution)
+{
+  levels_.clear();
+  if (_resolution < 3) return;
+
+  // finest grid
+  Level fine;
+  fine.n = _resolution;
+  fine.x.resize(_resolution);
+  for (int k = 0; k < _resolution; ++k) fine.x[k] = k;
+  levels_.push_back(fine);
+
+  // coarsen until a single inner point is left
+  while (levels_.back().n > 3)
+  {
+    const Level& f = levels_.back();
+
+    // keep every other point, and the last one
+    Level c;
+    c.n = (f.n - 1) / 2 + 1 + (f.n - 1) % 2;
+    c.x.resize(c.n);
+    for (int k = 0; k < c.n; ++k) c.x[k] = f.x[std::min(2 * k, f.n - 1)];
+
+    levels_.push_back(c);
+  }
+
+  for (Level& level : levels_) init_level(level);
+
+  // linear interpolation weights of each level from the next coarser one.
+  // Even points and the last point are coarse points themselves, odd points
+  // lie between two coarse points (halfway, except next to a short last
+  // interval).
+  for (size_t l = 0; l + 1 < levels_.size(); ++l)
+  {
+    Level&    f  = levels_[l];
+    const int nc = levels_[l + 1].n;
+
+    f.t.assign(size_t(f.n) * nc, 0.0);
+
+    f.coarse0.resize(f.n);
+    f.coarse1.resize(f.n);
+    f.weight0.resize(f.n);
+    f.weight1.resize(f.n);
+
+    for (int k = 0; k < f.n; ++k)
+    {
+      if (k % 2 == 0 || k == f.n - 1)
+      {
+        f.coarse0[k] = f.coarse1[k] = (k % 2 == 0) ? k / 2 : nc - 1;
+        f.weight0[k] = 1.0;
+        f.weight1[k] = 0.0;
+      }
+      else
+      {
+        f.coarse0[k] = (k - 1) / 2;
+        f.coarse1[k] = (k + 1) / 2;
+        f.weight0[k] = (f.x[k + 1] - f.x[k]) / (f.x[k + 1] - f.x[k - 1]);
+        f.weight1[k] = 1.0 - f.weight0[k];
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+size_t Multigrid::bytes(int _resolution)
+{
+  // u, f and r on every level, and t with the number of coarse columns
+  size_t values = 0;
+  for (int n = _resolution; n >= 3;)
+  {
+    const int nc = (n - 1) / 2 + 1 + (n - 1) % 2;
+    values += 3 * size_t(n) * n;
+    if (n == 3) break;
+    values += size_t(n) * nc;
+    n = nc;
+  }
+  return values * sizeof(Scalar);
+}
+
+//-----------------------------------------------------------------------------
+
+void Multigrid::init_level(Level& _level)
+{
+  const int n = _level.n;
+
+  _level.area.assign(n, 0.0);
+  _level.left.assign(n, 0.0);
+  _level.right.assign(n, 0.0);
+  _level.uniform = true;
+
+  for (int k = 1; k < n - 1; ++k)
+  {
+    const Scalar hl  = _level.x[k] - _level.x[k - 1];
+    const Scalar hr  = _level.x[k + 1] - _level.x[k];
+    _level.area[k]   = 0.5 * (hl + hr);
+    _level.left[k]   = 1.0 / hl;
+    _level.right[k]  = 1.0 / hr;
+    _level.uniform  &= (hl == 1.0 && hr == 1.0);
+  }
+
+  _level.u.assign(size_t(n) * n, 0.0);
+  _level.f.assign(size_t(n) * n, 0.0);
+  _level.r.assign(size_t(n) * n, 0.0);
+}
+
+//-----------------------------------------------------------------------------
+
+void Multigrid::smooth_row(Level& _level, int _i, int _color)
+{
+  const int     n    = _level.n;
+  Scalar*       mid  = _level.u.data() + size_t(_i) * n;
+  const Scalar* up   = mid - n;
+  const Scalar* down = mid + n;
+  const Scalar* rhs  = _level.f.data() + size_t(_i) * n;
+  const int     j0   = 1 + ((_i + 1 + _color) & 1);
+
+  if (_level.uniform)
+  {
+    for (int j = j0; j < n - 1; j += 2)
+      mid[j] = 0.25 * (rhs[j] + (mid[j - 1] + mid[j + 1]) + (up[j] + down[j]));
+  }
+  else
+  {
+    // A u = area_i (left_j (u - u_W) + right_j (u - u_E))
+    //     + area_j (left_i (u - u_S) + right_i (u - u_N))
+    const Scalar* area  = _level.area.data();
+    const Scalar* left  = _level.left.data();
+    const Scalar* right = _level.right.data();
+    const Scalar  ai = area[_i], si = left[_i], ni = right[_i];
+
+    for (int j = j0; j < n - 1; j += 2)
+    {
+      const Scalar w = ai * left[j], e = ai * right[j];
+      const Scalar b = area[j] * si, t = area[j] * ni;
+      mid[j] = (rhs[j] + w * mid[j - 1] + e * mid[j + 1] + b * up[j] +
+                t * down[j]) /
+               (w + e + b + t);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void Multigrid::smooth(Level& _level, int _sweeps)
+{
+  const int n = _level.n;
+
+  // red points (i+j even) first, then black ones. Black points of row i-1
+  // only depend on red points of rows i-2..i, so both colors are updated
+  // in a single pass over memory.
+  for (int s = 0; s < _sweeps; ++s)
+  {
+    for (int i = 1; i < n; ++i)
+    {
+      if (i < n - 1) smooth_row(_level, i, 0);
+      if (i > 1) smooth_row(_level, i - 1, 1);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+Scalar Multigrid::residual(Level& _level)
+{
+  const int     n = _level.n;
+  const Scalar* u = _level.u.data();
+  const Scalar* f = _level.f.data();
+  Scalar*       r = _level.r.data();
+
+  const Scalar* area  = _level.area.data();
+  const Scalar* left  = _level.left.data();
+  const Scalar* right = _level.right.data();
+
+  Scalar norm = 0.0;
+
+  for (int i = 1; i < n - 1; ++i)
+  {
+    const Scalar* mid  = u + size_t(i) * n;
+    const Scalar* up   = mid - n;
+    const Scalar* down = mid + n;
+    const Scalar* rhs  = f + size_t(i) * n;
+    Scalar*       res  = r + size_t(i) * n;
+
+    if (_level.uniform)
+    {
+      for (int j = 1; j < n - 1; ++j)
+        res[j] = rhs[j] - (4.0 * mid[j] - (mid[j - 1] + mid[j + 1]) -
+                           (up[j] + down[j]));
+    }
+    else
+    {
+      const Scalar ai = area[i], si = left[i], ni = right[i];
+      for (int j = 1; j < n - 1; ++j)
+      {
+        const Scalar w = ai * left[j], e = ai * right[j];
+        const Scalar b = area[j] * si, t = area[j] * ni;
+        res[j] = rhs[j] - (w * (mid[j] - mid[j - 1]) +
+                           e * (mid[j] - mid[j + 1]) +
+                           b * (mid[j] - up[j]) + t * (mid[j] - down[j]));
+      }
+    }
+
+    for (int j = 1; j < n - 1; ++j) norm += res[j] * res[j];
+  }
+
+  return std::sqrt(norm);
+}
+
+//-----------------------------------------------------------------------------
+
+Scalar Multigrid::rhs_norm(const Level& _level) const
+{
+  // f plus the couplings to the boundary values, i.e., the right hand side
+  // of the linear system for the inner points
+  const int n    = _level.n;
+  Scalar    norm = 0.0;
+
+  for (int i = 1; i < n - 1; ++i)
+  {
+    for (int j = 1; j < n - 1; ++j)
+    {
+      Scalar b = _level.f[i * n + j];
+      if (i == 1) b += _level.u[(i - 1) * n + j];
+      if (i == n - 2) b += _level.u[(i + 1) * n + j];
+      if (j == 1) b += _level.u[i * n + j - 1];
+      if (j == n - 2) b += _level.u[i * n + j + 1];
+      norm += b * b;
+    }
+  }
+
+  return std::sqrt(norm);
+}
+
+//-----------------------------------------------------------------------------
+
+void Multigrid::restrict_residual(int _l)
+{
+  Level&        fine   = levels_[_l];
+  Level&        coarse = levels_[_l + 1];
+  const int     nf     = fine.n;
+  const int     nc     = coarse.n;
+  const Scalar* r      = fine.r.data();
+  Scalar*       t      = fine.t.data();
+
+  // the transpose of the prolongation (full weighting), one direction after
+  // the other. First within each fine row...
+  for (int i = 1; i < nf - 1; ++i)
+  {
+    const Scalar* res = r + size_t(i) * nf;
+    Scalar*       row = t + size_t(i) * nc;
+
+    std::fill(row, row + nc, 0.0);
+    for (int j = 1; j < nf - 1; ++j)
+    {
+      row[fine.coarse0[j]] += fine.weight0[j] * res[j];
+      row[fine.coarse1[j]] += fine.weight1[j] * res[j];
+    }
+  }
+
+  // ...then across the rows
+  std::fill(coarse.f.begin(), coarse.f.end(), 0.0);
+  for (int i = 1; i < nf - 1; ++i)
+  {
+    const Scalar* row = t + size_t(i) * nc;
+    Scalar*       f0  = coarse.f.data() + size_t(fine.coarse0[i]) * nc;
+    Scalar*       f1  = coarse.f.data() + size_t(fine.coarse1[i]) * nc;
+    const Scalar  w0 = fine.weight0[i], w1 = fine.weight1[i];
+
+    for (int J = 0; J < nc; ++J) f0[J] += w0 * row[J];
+    if (w1 != 0.0)
+      for (int J = 0; J < nc; ++J) f1[J] += w1 * row[J];
+  }
+
+  // the correction starts at zero, and is zero on the boundary
+  std::fill(coarse.u.begin(), coarse.u.end(), 0.0);
+}
+
+//-----------------------------------------------------------------------------
+
+void Multigrid::prolongate(int _l)
+{
+  Level&        fine   = levels_[_l];
+  const Level&  coarse = levels_[_l + 1];
+  const int     nf     = fine.n;
+  const int     nc     = coarse.n;
+  const Scalar* e      = coarse.u.data();
+
+  for (int i = 1; i < nf - 1; ++i)
+  {
+    const Scalar* e0 = e + size_t(fine.coarse0[i]) * nc;
+    const Scalar* e1 = e + size_t(fine.coarse1[i]) * nc;
+    const Scalar  w0 = fine.weight0[i], w1 = fine.weight1[i];
+    Scalar*       u  = fine.u.data() + size_t(i) * nf;
+
+    for (int j = 1; j < nf - 1; ++j)
+    {
+      const int J0 = fine.coarse0[j], J1 = fine.coarse1[j];
+      const Scalar v0 = fine.weight0[j], v1 = fine.weight1[j];
+      u[j] += w0 * (v0 * e0[J0] + v1 * e0[J1]) + w1 * (v0 * e1[J0] + v1 * e1[J1]);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void Multigrid::cycle(int _l, Cycle _cycle)
+{
+  Level& level = levels_[_l];
+
+  // coarsest grid: a single inner point, which one sweep solves exactly
+  if (_l + 1 == int(levels_.size()))
+  {
+    smooth(level, 1);
+    return;
+  }
+
+  smooth(level, pre_smoothing);
+  residual(level);
+  restrict_residual(_l);
+
+  // V: one coarse cycle. F: an F-cycle followed by a V-cycle.
+  cycle(_l + 1, _cycle);
+  if (_cycle == F_CYCLE) cycle(_l + 1, V_CYCLE);
+
+  prolongate(_l);
+  smooth(level, post_smoothing);
+}
+
+//-----------------------------------------------------------------------------
+
+int Multigrid::solve(Scalar _tolerance, int _max_cycles, Cycle _cycle)
+{
+  if (levels_.empty()) return 0;
+
+  Level&       fine = levels_[0];
+  const Scalar norm = rhs_norm(fine);
+
+  int c = 0;
+  for (;; ++c)
+  {
+    residual_ = residual(fine) / (norm > 0.0 ? norm : 1.0);
+    if (residual_ < _tolerance || c == _max_cycles) break;
+    cycle(0, _cycle);
+  }
+
+  return c;
+}
+
+//=============================================================================